@@ -0,0 +1,117 @@
+#include "include/batch_runner.h"
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: Lab_7_batch [--runs N] [--npcs N] [--ticks N] [--seed S] [--threads N]" << std::endl;
+}
+
+// целое без знака; отрицательные и нечисловые значения не принимаются
+bool parseNumber(const char* text, unsigned long long& value) {
+    if (!std::isdigit(static_cast<unsigned char>(*text))) return false;
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoull(text, &end, 10);
+    return *end == '\0' && errno == 0;
+}
+
+// гистограмма одной строкой: "выжило:симуляций" для непустых корзин
+std::string histogramLine(const std::vector<size_t>& histogram) {
+    std::string line;
+    for (size_t k = 0; k < histogram.size(); ++k) {
+        if (histogram[k] == 0) continue;
+        if (!line.empty()) line += ' ';
+        line += std::to_string(k) + ":" + std::to_string(histogram[k]);
+    }
+    return line;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    BatchConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        const char* text = argv[++i];
+        unsigned long long value = 0;
+        if (!parseNumber(text, value)) {
+            std::cerr << "Error: invalid value for " << arg << ": " << text << std::endl;
+            return 1;
+        }
+        // без симуляций нечего усреднять, а ноль потоков пул понимает как "все ядра"
+        if ((arg == "--runs" || arg == "--threads") && value == 0) {
+            std::cerr << "Error: " << arg << " must be positive" << std::endl;
+            return 1;
+        }
+        if (arg == "--runs") {
+            config.simulations = value;
+        } else if (arg == "--npcs") {
+            config.npc_count = static_cast<int>(value);
+        } else if (arg == "--ticks") {
+            config.ticks = value;
+        } else if (arg == "--seed") {
+            config.base_seed = value;
+        } else if (arg == "--threads") {
+            config.threads = value;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    try {
+        std::cout << "=== Batch NPC Battle ===" << std::endl;
+        std::cout << "Simulations: " << config.simulations << ", NPCs: " << config.npc_count
+                  << ", ticks: " << config.ticks << ", seeds: " << config.base_seed << ".."
+                  << config.base_seed + config.simulations - 1 << std::endl;
+
+        BatchResult result = BatchRunner(config).run();
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Finished in " << result.seconds << " s";
+        if (result.seconds > 0) {
+            std::cout << " (" << result.simulations / result.seconds << " simulations/s)";
+        }
+        std::cout << std::endl;
+        std::cout << std::endl;
+
+        std::cout << std::left << std::setw(8) << "Type" << std::right
+                  << std::setw(10) << "mean" << std::setw(10) << "stddev"
+                  << std::setw(8) << "min" << std::setw(8) << "max" << "  histogram" << std::endl;
+        for (size_t t = 0; t < kNpcTypeCount; ++t) {
+            const auto& stats = result.by_type[t];
+            std::cout << std::left << std::setw(8) << npcTypeName(static_cast<NpcType>(t)) << std::right
+                      << std::setw(10) << stats.survivors.mean()
+                      << std::setw(10) << std::sqrt(stats.survivors.variance())
+                      << std::setw(8) << std::setprecision(0) << stats.survivors.min()
+                      << std::setw(8) << stats.survivors.max() << std::setprecision(3)
+                      << "  " << histogramLine(stats.histogram) << std::endl;
+        }
+        std::cout << std::endl;
+        std::cout << "Survivors per run: " << result.total_survivors.mean()
+                  << " +- " << std::sqrt(result.total_survivors.variance()) << std::endl;
+        std::cout << "Battles per run:   " << result.battles.mean()
+                  << " +- " << std::sqrt(result.battles.variance()) << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+// Бенчмарк боёв: сколько задач в секунду разрешают 1..N потоков боёв.
+// Очереди заполняются одним тиком на плотной карте, затем разбираются.
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../include/arena.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void populate(Arena& arena, int count) {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<> coord(0, 100);
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    for (int i = 0; i < count; ++i) {
+        arena.createAndAddNpc(types[i % 3], "npc_" + std::to_string(i), coord(gen), coord(gen));
+    }
+}
+
+}
+
+int main() {
+    const int npcCount = 1500;
+    const int maxWorkers = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+
+    std::printf("%8s %12s %16s %10s\n", "workers", "tasks", "battles/sec", "alive");
+    for (int workers = 1; workers <= maxWorkers; workers *= 2) {
+        Arena arena(100, 100);
+        populate(arena, npcCount);
+        arena.setBattleWorkers(workers);
+        arena.configureBattleQueue({1 << 20, OverflowPolicy::Drop});
+        arena.tick();
+        size_t tasks = arena.getPendingBattles();
+
+        auto start = Clock::now();
+        size_t processed = arena.drainBattles(workers);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (processed != tasks) {
+            std::printf("processed %zu of %zu tasks\n", processed, tasks);
+        }
+        std::printf("%8d %12zu %16.0f %10zu\n", workers, tasks, processed / seconds, arena.getAliveCount());
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+// Проверка "кто кого может убить": прежнее сравнение строк типа, которые
+// getType() возвращал по значению, против таблицы убийств по NpcType.
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/combat_visitor.h"
+#include "../include/factory.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kNpcCount = 1024;
+const long kCalls = 20000000;
+
+// прежние NPC и CombatVisitor: тип - строка, копируемая при каждом запросе
+class LegacyNpc {
+    public:
+        explicit LegacyNpc(const std::string& type) : type_(type) {}
+        std::string getType() const { return type_; }
+
+    private:
+        std::string type_;
+};
+
+bool legacyCanKill(const LegacyNpc* attacker, const LegacyNpc* defender) {
+    if (attacker->getType() == "Dragon") {
+        return defender->getType() == "Elf";
+    } else if (attacker->getType() == "Elf") {
+        return defender->getType() == "Druid";
+    } else if (attacker->getType() == "Druid") {
+        return defender->getType() == "Dragon";
+    }
+    return false;
+}
+
+// не даёт компилятору свернуть цикл с независимыми от итерации результатами
+template <typename T>
+void keep(const T& value) {
+    asm volatile("" : : "g"(value) : "memory");
+}
+
+template <typename Check>
+double callsPerSecond(Check check) {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> pick(0, kNpcCount - 1);
+    std::vector<int> order(4096);
+    for (auto& index : order) {
+        index = pick(gen);
+    }
+
+    long kills = 0;
+    auto start = Clock::now();
+    for (long i = 0; i < kCalls; ++i) {
+        kills += check(order[i & 4095], order[(i + 1) & 4095]);
+        keep(kills);
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return kCalls / seconds;
+}
+
+}
+
+int main() {
+    const char* names[] = {"Dragon", "Elf", "Druid"};
+
+    std::vector<LegacyNpc> legacy;
+    std::vector<std::unique_ptr<Npc>> npcs;
+    std::vector<NpcType> types;
+    for (int i = 0; i < kNpcCount; ++i) {
+        legacy.emplace_back(names[i % 3]);
+        npcs.push_back(NpcFactory::createNpc(names[i % 3], "npc_" + std::to_string(i), 0, 0));
+        types.push_back(npcs.back()->getTypeId());
+    }
+
+    CombatVisitor visitor;
+    std::printf("%24s %16s\n", "variant", "canKill/sec");
+    std::printf("%24s %16.0f\n", "legacy string compare", callsPerSecond([&](int a, int b) {
+        return legacyCanKill(&legacy[a], &legacy[b]);
+    }));
+    std::printf("%24s %16.0f\n", "CombatVisitor (Npc*)", callsPerSecond([&](int a, int b) {
+        return visitor.canKill(npcs[a].get(), npcs[b].get());
+    }));
+    std::printf("%24s %16.0f\n", "kill matrix (NpcType)", callsPerSecond([&](int a, int b) {
+        return canKill(types[a], types[b]);
+    }));
+    return 0;
+}
\ No newline at end of file
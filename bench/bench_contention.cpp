@@ -0,0 +1,134 @@
+// Микробенчмарк конкуренции: поток движения двигает NPC, а потоки боёв
+// одновременно читают позиции, считают дистанции и пытаются убить тех же NPC.
+// Сравнивается упакованное атомарное состояние с прежним вариантом на мьютексах.
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../include/elf.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kNpcCount = 64;
+const auto kDuration = std::chrono::milliseconds(500);
+
+// прежняя схема: отдельный мьютекс на каждый NPC
+class LockedNpc {
+    public:
+        void setPosition(int x, int y) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            x_ = x;
+            y_ = y;
+        }
+        bool isAlive() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return alive_;
+        }
+        bool kill() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            bool wasAlive = alive_;
+            alive_ = false;
+            return wasAlive;
+        }
+        double distanceTo(const LockedNpc& other) const {
+            if (this == &other) return 0.0;
+            // scoped_lock избегает взаимной блокировки, которой подвержен старый код
+            std::scoped_lock lock(mutex_, other.mutex_);
+            int dx = x_ - other.x_;
+            int dy = y_ - other.y_;
+            return std::sqrt(dx * dx + dy * dy);
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        int x_ = 0;
+        int y_ = 0;
+        bool alive_ = true;
+};
+
+struct Result {
+    double moves_per_sec;
+    double checks_per_sec;
+};
+
+template <typename T>
+Result run(std::vector<T>& npcs, int battleThreads) {
+    std::atomic<bool> running{true};
+    std::atomic<long> moves{0};
+    std::atomic<long> checks{0};
+
+    std::thread mover([&] {
+        std::mt19937 gen(1);
+        std::uniform_int_distribution<> coord(0, 100);
+        long local = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            for (auto& npc : npcs) {
+                npc.setPosition(coord(gen), coord(gen));
+            }
+            local += static_cast<long>(npcs.size());
+        }
+        moves += local;
+    });
+
+    std::vector<std::thread> fighters;
+    for (int t = 0; t < battleThreads; ++t) {
+        fighters.emplace_back([&, t] {
+            std::mt19937 gen(100 + t);
+            std::uniform_int_distribution<> pick(0, kNpcCount - 1);
+            long local = 0;
+            double sink = 0.0;
+            while (running.load(std::memory_order_relaxed)) {
+                T& a = npcs[pick(gen)];
+                T& b = npcs[pick(gen)];
+                if (a.isAlive() && b.isAlive()) {
+                    sink += a.distanceTo(b);
+                }
+                if ((local & 1023) == 0) {
+                    a.kill();
+                }
+                local++;
+            }
+            checks += local + (sink < 0 ? 1 : 0);
+        });
+    }
+
+    auto start = Clock::now();
+    std::this_thread::sleep_for(kDuration);
+    running = false;
+    mover.join();
+    for (auto& thread : fighters) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return {moves / seconds, checks / seconds};
+}
+
+}
+
+int main() {
+    std::printf("%8s %10s %16s %16s\n", "state", "fighters", "moves/sec", "checks/sec");
+
+    for (int battleThreads : {1, 2, 4}) {
+        std::vector<LockedNpc> locked(kNpcCount);
+        Result lockedResult = run(locked, battleThreads);
+        std::printf("%8s %10d %16.0f %16.0f\n", "mutex", battleThreads,
+                    lockedResult.moves_per_sec, lockedResult.checks_per_sec);
+
+        std::vector<Elf> atomicNpcs;
+        atomicNpcs.reserve(kNpcCount);
+        for (int i = 0; i < kNpcCount; ++i) {
+            atomicNpcs.emplace_back(0, 0, "Elf_" + std::to_string(i));
+        }
+        Result atomicResult = run(atomicNpcs, battleThreads);
+        std::printf("%8s %10d %16.0f %16.0f\n", "atomic", battleThreads,
+                    atomicResult.moves_per_sec, atomicResult.checks_per_sec);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+// Метрики дедупликации боёв на плотной карте 100x100: сколько повторов пар
+// отсекает множество ожидающих боёв, когда потоки боёв отстают от движения.
+#include <cstdio>
+#include <random>
+#include "../include/arena.h"
+
+namespace {
+
+void populate(Arena& arena, int count) {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<> coord(0, 100);
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    for (int i = 0; i < count; ++i) {
+        arena.createAndAddNpc(types[i % 3], "npc_" + std::to_string(i), coord(gen), coord(gen));
+    }
+}
+
+}
+
+int main() {
+    const int npcCount = 300;
+    const int ticks = 30;
+
+    std::printf("%8s %10s %12s %12s %12s %10s\n",
+                "npcs", "drain/N", "detected", "enqueued", "coalesced", "removed");
+    for (int drainEvery : {1, 2, 5, 10}) {
+        Arena arena(100, 100);
+        arena.configureBattleQueue({1 << 20, OverflowPolicy::Drop});
+        populate(arena, npcCount);
+
+        // бои разрешаются раз в drainEvery тиков - потоки боёв отстают
+        for (int tick = 1; tick <= ticks; ++tick) {
+            arena.tick();
+            if (tick % drainEvery == 0) {
+                arena.drainBattles(1);
+            }
+        }
+
+        BattleQueueStats stats = arena.getBattleQueueStats();
+        size_t detected = stats.enqueued + stats.coalesced + stats.dropped;
+        double removed = detected ? 100.0 * stats.coalesced / detected : 0.0;
+        std::printf("%8d %10d %12zu %12zu %12zu %9.1f%%\n",
+                    npcCount, drainEvery, detected, stats.enqueued, stats.coalesced, removed);
+    }
+    return 0;
+}
\ No newline at end of file
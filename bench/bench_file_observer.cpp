@@ -0,0 +1,89 @@
+// Пропускная способность журнала боёв в файл: прежний наблюдатель открывает
+// и закрывает файл на каждое событие, новый держит его открытым и пишет блоками.
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../include/file_observer.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// прежняя реализация FileObserver
+class LegacyFileObserver : public Observer {
+    public:
+        explicit LegacyFileObserver(const std::string& filename) : filename_(filename) {}
+
+        void notify(const std::string& event) override {
+            std::ofstream file(filename_, std::ios::app);
+            if (file.is_open()) {
+                file << event << std::endl;
+            }
+        }
+
+    private:
+        std::string filename_;
+};
+
+std::vector<std::string> makeEvents(int count) {
+    std::vector<std::string> events;
+    events.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        events.push_back("Dragon 'npc_" + std::to_string(i) + "' killed Elf 'npc_" +
+                         std::to_string(i + 1) + "' (attack " + std::to_string(i % 6 + 1) +
+                         " vs defense " + std::to_string((i + 3) % 6 + 1) + ")");
+    }
+    return events;
+}
+
+double eventsPerSecond(Observer& observer, const std::vector<std::string>& events, size_t batch) {
+    auto start = Clock::now();
+    if (batch <= 1) {
+        for (const auto& event : events) {
+            observer.notify(event);
+        }
+    } else {
+        std::vector<std::string> chunk;
+        for (size_t i = 0; i < events.size(); i += batch) {
+            size_t end = std::min(events.size(), i + batch);
+            chunk.assign(events.begin() + i, events.begin() + end);
+            observer.notifyBatch(chunk);
+        }
+    }
+    observer.flush();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return events.size() / seconds;
+}
+
+}
+
+int main() {
+    const char* path = "bench_file_observer.log";
+    const auto events = makeEvents(200000);
+    const auto legacyEvents = std::vector<std::string>(events.begin(), events.begin() + 20000);
+
+    std::printf("%12s %8s %16s %10s %14s\n", "observer", "batch", "events/sec", "flushes", "max flush us");
+
+    for (size_t batch : {1, 256}) {
+        std::remove(path);
+        LegacyFileObserver legacy(path);
+        double legacyRate = eventsPerSecond(legacy, legacyEvents, batch);
+        std::printf("%12s %8zu %16.0f %10s %14s\n", "legacy", batch, legacyRate, "-", "-");
+
+        std::remove(path);
+        FileObserverStats stats;
+        double rate;
+        {
+            FileObserver buffered(path);
+            rate = eventsPerSecond(buffered, events, batch);
+            stats = buffered.getStats();
+        }
+        std::printf("%12s %8zu %16.0f %10zu %14.1f\n", "buffered", batch, rate, stats.flushes,
+                    stats.max_flush_latency.count() / 1000.0);
+    }
+
+    std::remove(path);
+    return 0;
+}
\ No newline at end of file
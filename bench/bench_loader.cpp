@@ -0,0 +1,122 @@
+// Бенчмарк сохранений: построчное чтение (getline, istringstream в фабрике
+// и addNpc на каждого NPC) против loadFromFile с отображением файла в память
+// и вставкой под одной блокировкой; запись и чтение текстового и двоичного формата.
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include "../include/arena.h"
+#include "../include/factory.h"
+#include "../include/checkpointer.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kWorld = 100000;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void writeScenario(const std::string& filename, int count) {
+    std::mt19937 gen(count);
+    std::uniform_int_distribution<> coord(0, kWorld);
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    std::ofstream file(filename);
+    for (int i = 0; i < count; ++i) {
+        file << types[i % 3] << " npc_" << i << ' ' << coord(gen) << ' ' << coord(gen) << '\n';
+    }
+}
+
+// прежний загрузчик
+size_t loadLineByLine(Arena& arena, const std::string& filename) {
+    std::ifstream file(filename);
+    std::string line;
+    size_t loaded = 0;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        arena.addNpc(NpcFactory::createFromString(line));
+        loaded++;
+    }
+    return loaded;
+}
+
+void report(const char* name, size_t bytes, size_t npcs, double seconds) {
+    std::printf("%-14s %10.1f %14.0f %10.1f\n", name, bytes / seconds / (1 << 20), npcs / seconds, seconds * 1e3);
+}
+
+size_t fileSize(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    return static_cast<size_t>(file.tellg());
+}
+
+}
+
+int main() {
+    const std::string filename = "bench_loader_scenario.txt";
+    const std::string binary = "bench_loader_scenario.bin";
+    std::printf("%-14s %10s %14s %10s\n", "operation", "MB/s", "NPCs/s", "ms");
+
+    for (int count : {100000, 1000000}) {
+        writeScenario(filename, count);
+        std::printf("-- %d NPCs\n", count);
+
+        Arena arena(kWorld, kWorld);
+        auto start = Clock::now();
+        LoadReport result = arena.loadFromFile(filename);
+        double seconds = secondsSince(start);
+        if (!result.ok() || result.loaded != static_cast<size_t>(count)) {
+            std::printf("load errors: %zu, loaded %zu\n", result.errors.size(), result.loaded);
+        }
+        report("load text", result.bytes, result.loaded, seconds);
+
+        {
+            Arena legacy(kWorld, kWorld);
+            start = Clock::now();
+            size_t loaded = loadLineByLine(legacy, filename);
+            report("load by line", result.bytes, loaded, secondsSince(start));
+        }
+
+        start = Clock::now();
+        arena.saveToFile(filename, SaveFormat::Text);
+        report("save text", fileSize(filename), count, secondsSince(start));
+
+        start = Clock::now();
+        arena.saveToFile(binary, SaveFormat::Binary);
+        report("save binary", fileSize(binary), count, secondsSince(start));
+
+        Arena copy(kWorld, kWorld);
+        start = Clock::now();
+        result = copy.loadFromFile(binary);
+        report("load binary", result.bytes, result.loaded, secondsSince(start));
+
+        // контрольные точки: полный снимок, дельта после одного тика, восстановление
+        const auto directory = std::filesystem::temp_directory_path() / "lab7_bench_checkpoint";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        {
+            Checkpointer checkpointer(copy, {directory.string(), std::chrono::milliseconds(1000), 10});
+            start = Clock::now();
+            checkpointer.checkpointNow();
+            size_t fullBytes = checkpointer.getStats().bytes;
+            report("checkpoint", fullBytes, count, secondsSince(start));
+
+            copy.runHeadless(1);
+            start = Clock::now();
+            checkpointer.checkpointNow();
+            report("delta", checkpointer.getStats().bytes - fullBytes, count, secondsSince(start));
+        }
+        Arena restored(kWorld, kWorld);
+        start = Clock::now();
+        result = restored.restoreCheckpoint(directory.string());
+        report("restore", result.bytes, result.loaded, secondsSince(start));
+        std::filesystem::remove_all(directory);
+    }
+
+    std::remove(filename.c_str());
+    std::remove(binary.c_str());
+    return 0;
+}
\ No newline at end of file
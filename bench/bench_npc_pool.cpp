@@ -0,0 +1,83 @@
+// Бенчмарк цикла создания и очистки: NPC из кучи (NpcFactory + insert, как было)
+// против NPC из пула хранилища (emplace). Очистка пула не обходит объекты.
+// Длинные имена не помещаются в SSO строки, и в варианте с кучей выделяются отдельно.
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../include/factory.h"
+#include "../include/npc_store.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Cycle {
+    double create = 0;
+    double clear = 0;
+};
+
+std::vector<std::string> makeNames(size_t count, const char* prefix) {
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        names.push_back(prefix + std::to_string(i));
+    }
+    return names;
+}
+
+NpcType typeOf(size_t i) {
+    return static_cast<NpcType>(i % kNpcTypeCount);
+}
+
+template <typename Create>
+Cycle runCycles(NpcStore& store, const std::vector<std::string>& names, int rounds, Create create) {
+    Cycle best{1e9, 1e9};
+    for (int round = 0; round < rounds; ++round) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < names.size(); ++i) {
+            create(store, i, names[i]);
+        }
+        double created = secondsSince(start);
+
+        start = Clock::now();
+        store.clear();
+        double cleared = secondsSince(start);
+
+        if (created < best.create) best.create = created;
+        if (cleared < best.clear) best.clear = cleared;
+    }
+    return best;
+}
+
+}
+
+int main() {
+    const int rounds = 5;
+    std::printf("create + clear cycle, best of %d\n", rounds);
+    std::printf("%8s %6s %14s %14s %12s %12s\n", "npcs", "names", "heap ns/npc", "pool ns/npc", "heap clr ms",
+                "pool clr ms");
+
+    for (size_t count : {10000, 100000, 1000000}) {
+        for (const char* prefix : {"npc_", "a_rather_long_npc_name_"}) {
+            const auto names = makeNames(count, prefix);
+            NpcStore store;
+            store.reserve(count);
+
+            Cycle heap = runCycles(store, names, rounds, [](NpcStore& s, size_t i, const std::string& name) {
+                s.insert(NpcFactory::createNpc(typeOf(i), name, static_cast<int>(i % 500), 0));
+            });
+            Cycle pool = runCycles(store, names, rounds, [](NpcStore& s, size_t i, const std::string& name) {
+                s.emplace(typeOf(i), name, static_cast<int>(i % 500), 0);
+            });
+
+            std::printf("%8zu %6s %14.1f %14.1f %12.2f %12.3f\n", count, names.front().size() > 15 ? "long" : "short",
+                        heap.create * 1e9 / count, pool.create * 1e9 / count, heap.clear * 1e3, pool.clear * 1e3);
+        }
+    }
+    return 0;
+}
\ No newline at end of file
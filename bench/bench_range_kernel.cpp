@@ -0,0 +1,117 @@
+// Микробенчмарк проверки дистанции: один NPC против блока кандидатов.
+// Прежний способ (sqrt на double и canKill для каждой пары) против ядра
+// range_kernel.h в каждой доступной реализации. Выводит пары в секунду.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/range_kernel.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t kCandidates = 1 << 16;
+const int kQueries = 2000;
+const int64_t kRange = 30;
+
+struct Data {
+    std::vector<int32_t> xs;
+    std::vector<int32_t> ys;
+    std::vector<uint8_t> types;
+    std::vector<RangeQuery> queries;
+};
+
+Data makeData() {
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int32_t> coord(0, 200);
+    std::uniform_int_distribution<int> type(0, kNpcTypeCount - 1);
+    Data data;
+    for (size_t i = 0; i < kCandidates; ++i) {
+        data.xs.push_back(coord(gen));
+        data.ys.push_back(coord(gen));
+        data.types.push_back(static_cast<uint8_t>(type(gen)));
+    }
+    for (int i = 0; i < kQueries; ++i) {
+        NpcType own = static_cast<NpcType>(type(gen));
+        data.queries.push_back({coord(gen), coord(gen), kRange * kRange, hostileTypes(own)});
+    }
+    return data;
+}
+
+// прежняя проверка пары
+size_t naive(const Data& data, size_t block, size_t& hits) {
+    size_t pairs = 0;
+    for (int q = 0; q < kQueries; ++q) {
+        const RangeQuery& query = data.queries[q];
+        const size_t first = (q * block) % (kCandidates - block);
+        for (size_t j = first; j < first + block; ++j) {
+            double dx = data.xs[j] - query.x;
+            double dy = data.ys[j] - query.y;
+            if (std::sqrt(dx * dx + dy * dy) > static_cast<double>(kRange)) continue;
+            if (query.hostile >> data.types[j] & 1u) hits++;
+        }
+        pairs += block;
+    }
+    return pairs;
+}
+
+size_t kernel(const Data& data, size_t block, RangeKernel implementation, size_t& hits) {
+    size_t pairs = 0;
+    for (int q = 0; q < kQueries; ++q) {
+        const size_t first = (q * block) % (kCandidates - block);
+        for (size_t offset = 0; offset < block; offset += kRangeBlockSize) {
+            const size_t count = std::min(kRangeBlockSize, block - offset);
+            const size_t at = first + offset;
+            uint64_t mask = rangeMask(implementation, data.queries[q],
+                                      {data.xs.data() + at, data.ys.data() + at, data.types.data() + at, count});
+            hits += static_cast<size_t>(__builtin_popcountll(mask));
+        }
+        pairs += block;
+    }
+    return pairs;
+}
+
+template <typename Run>
+double pairsPerSecond(Run run, size_t& hits) {
+    // прогрев и не меньше 0.2 с измерения
+    size_t pairs = 0;
+    run(hits);
+    hits = 0;
+    auto start = Clock::now();
+    double seconds = 0;
+    int rounds = 0;
+    do {
+        pairs += run(hits);
+        rounds++;
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (seconds < 0.2);
+    hits /= rounds;
+    return pairs / seconds;
+}
+
+}
+
+int main() {
+    const Data data = makeData();
+    std::printf("range check, radius %lld, active kernel: %s\n", static_cast<long long>(kRange),
+                rangeKernelName(activeRangeKernel()));
+    std::printf("%8s %10s %14s %10s %9s\n", "block", "method", "Mpairs/s", "hits", "speedup");
+
+    for (size_t block : {8, 16, 64, 1024}) {
+        size_t naiveHits = 0;
+        double base = pairsPerSecond([&](size_t& hits) { return naive(data, block, hits); }, naiveHits);
+        std::printf("%8zu %10s %14.1f %10zu %8.1fx\n", block, "sqrt", base / 1e6, naiveHits, 1.0);
+
+        for (RangeKernel implementation : {RangeKernel::Scalar, RangeKernel::SSE41, RangeKernel::AVX2}) {
+            if (!rangeKernelSupported(implementation)) continue;
+            size_t hits = 0;
+            double rate = pairsPerSecond([&](size_t& h) { return kernel(data, block, implementation, h); }, hits);
+            std::printf("%8zu %10s %14.1f %10zu %8.1fx\n", block, rangeKernelName(implementation), rate / 1e6, hits,
+                        rate / base);
+        }
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+// Задержка писателя при активных читателях: читатели обходят всех NPC
+// либо под разделяемой блокировкой (прежняя схема), либо по опубликованному
+// снимку. Писатель берёт эксклюзивную блокировку, как startBattle и addNpc.
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "../include/elf.h"
+#include "../include/npc_store.h"
+#include "../include/snapshot_publisher.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kNpcCount = 20000;
+const int kReaders = 3;
+const auto kDuration = std::chrono::milliseconds(700);
+
+// корзина k - задержки в [2^k, 2^(k+1)) наносекунд
+struct LatencyHistogram {
+    std::array<size_t, 40> buckets{};
+    size_t count = 0;
+    long long max_ns = 0;
+
+    void add(long long ns) {
+        size_t bucket = 0;
+        while (bucket + 1 < buckets.size() && (1ll << (bucket + 1)) <= ns) bucket++;
+        buckets[bucket]++;
+        count++;
+        if (ns > max_ns) max_ns = ns;
+    }
+
+    long long percentile(double p) const {
+        size_t target = static_cast<size_t>(p * count);
+        size_t seen = 0;
+        for (size_t k = 0; k < buckets.size(); ++k) {
+            seen += buckets[k];
+            if (seen > target) return 1ll << (k + 1);
+        }
+        return max_ns;
+    }
+};
+
+struct Snapshot {
+    std::vector<NpcState::Value> states;
+};
+
+std::unique_ptr<Snapshot> takeSnapshot(const NpcStore& store) {
+    auto snapshot = std::make_unique<Snapshot>();
+    snapshot->states.reserve(store.size());
+    for (uint32_t i = 0; i < store.slotCount(); ++i) {
+        snapshot->states.push_back(store.loadState(i));
+    }
+    return snapshot;
+}
+
+LatencyHistogram run(bool useSnapshots) {
+    NpcStore store;
+    for (int i = 0; i < kNpcCount; ++i) {
+        store.insert(std::make_unique<Elf>(i % 100, i % 97, "Elf_" + std::to_string(i)));
+    }
+    std::shared_mutex mutex;
+    SnapshotPublisher<Snapshot> publisher;
+    publisher.publish(takeSnapshot(store));
+
+    std::atomic<bool> running{true};
+    std::atomic<long> reads{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < kReaders; ++r) {
+        readers.emplace_back([&] {
+            long local = 0;
+            size_t alive = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                if (useSnapshots) {
+                    auto snapshot = publisher.acquire();
+                    for (const auto& state : snapshot->states) alive += state.alive;
+                } else {
+                    std::shared_lock<std::shared_mutex> lock(mutex);
+                    for (uint32_t i = 0; i < store.slotCount(); ++i) alive += store.isAlive(i);
+                }
+                local++;
+            }
+            reads += local + (alive == 0 ? 1 : 0);
+        });
+    }
+
+    // при приоритете читателей писатель может не получить блокировку вовсе,
+    // поэтому он работает в своём потоке, а время замера отсчитывает главный
+    LatencyHistogram histogram;
+    std::thread writer([&] {
+        uint32_t slot = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            auto start = Clock::now();
+            {
+                std::unique_lock<std::shared_mutex> lock(mutex);
+                histogram.add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+                store.setPosition(slot, static_cast<int>(slot % 100), static_cast<int>(slot % 89));
+            }
+            slot = (slot + 1) % kNpcCount;
+            if (useSnapshots) {
+                std::shared_lock<std::shared_mutex> lock(mutex);
+                publisher.publish(takeSnapshot(store));
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+
+    std::this_thread::sleep_for(kDuration);
+    running = false;
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    std::printf("  reads/sec: %.0f\n", reads / std::chrono::duration<double>(kDuration).count());
+    return histogram;
+}
+
+void print(const char* name, const LatencyHistogram& histogram) {
+    std::printf("%s: writes %zu, p50 <%lld ns, p99 <%lld ns, max %lld ns\n", name, histogram.count,
+                histogram.percentile(0.5), histogram.percentile(0.99), histogram.max_ns);
+    for (size_t k = 0; k < histogram.buckets.size(); ++k) {
+        if (histogram.buckets[k] == 0) continue;
+        std::printf("  [%10lld, %10lld) ns %8zu\n", 1ll << k, 1ll << (k + 1), histogram.buckets[k]);
+    }
+}
+
+}
+
+int main() {
+    std::printf("Writer lock wait with %d readers over %d NPCs\n", kReaders, kNpcCount);
+    LatencyHistogram locked = run(false);
+    print("shared_lock readers", locked);
+    LatencyHistogram snapshots = run(true);
+    print("snapshot readers", snapshots);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+// Бенчмарк startBattle: полный перебор пар (как было) против поиска по сетке
+// на 1 и на всех потоках. Плотность одинаковая, меняется только число NPC.
+// Полный перебор на 100k NPC идёт долго, его можно пропустить ключом --no-naive.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../include/arena.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const double kRange = 10.0;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// прежний алгоритм: все пары по снимку, возвращает число боёв
+size_t naiveBattles(const WorldSnapshot& world) {
+    size_t battles = 0;
+    const auto& npcs = world.npcs;
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        for (size_t j = i + 1; j < npcs.size(); ++j) {
+            double dx = npcs[i].x - npcs[j].x;
+            double dy = npcs[i].y - npcs[j].y;
+            if (std::sqrt(dx * dx + dy * dy) > kRange) continue;
+            if (canKill(npcs[i].type, npcs[j].type) || canKill(npcs[j].type, npcs[i].type)) battles++;
+        }
+    }
+    return battles;
+}
+
+class BattleCounter : public Observer {
+    public:
+        void notify(const std::string&) override {}
+        void onBattle(const BattleEvent&, const BattleEventContext&) override { battles++; }
+        size_t battles = 0;
+};
+
+double timeStartBattle(int side, int count, size_t threads, size_t& battles) {
+    Arena arena(side, side);
+    arena.setSeed(count);
+    arena.setWorkerThreads(threads);
+    arena.generateRandomNpcs(count, false);
+    auto counter = std::make_shared<BattleCounter>();
+    arena.addObserver(counter);
+
+    auto start = Clock::now();
+    arena.startBattle(kRange);
+    double seconds = secondsSince(start);
+    battles = counter->battles;
+    return seconds;
+}
+
+}
+
+int main(int argc, char** argv) {
+    bool naive = !(argc > 1 && std::strcmp(argv[1], "--no-naive") == 0);
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("startBattle(%.0f), ~1 NPC per 400 cells, %zu cores\n", kRange, cores);
+    std::printf("%8s %10s %12s %12s %12s %10s\n", "npcs", "battles", "naive ms", "grid 1t ms", "grid Nt ms", "speedup");
+
+    for (int count : {10000, 100000}) {
+        const int side = static_cast<int>(std::sqrt(count * 400.0));
+
+        size_t battles = 0;
+        double single = timeStartBattle(side, count, 1, battles);
+        size_t parallelBattles = 0;
+        double parallel = timeStartBattle(side, count, cores, parallelBattles);
+        if (parallelBattles != battles) {
+            std::printf("battle count mismatch: %zu vs %zu\n", parallelBattles, battles);
+        }
+
+        double naiveSeconds = -1;
+        if (naive) {
+            Arena arena(side, side);
+            arena.setSeed(count);
+            arena.generateRandomNpcs(count, false);
+            auto world = arena.snapshot();
+            auto start = Clock::now();
+            size_t naiveCount = naiveBattles(*world);
+            naiveSeconds = secondsSince(start);
+            if (naiveCount != battles) {
+                std::printf("battle count mismatch: naive %zu vs grid %zu\n", naiveCount, battles);
+            }
+        }
+
+        if (naiveSeconds >= 0) {
+            std::printf("%8d %10zu %12.1f %12.2f %12.2f %9.0fx\n", count, battles, naiveSeconds * 1e3,
+                        single * 1e3, parallel * 1e3, naiveSeconds / parallel);
+        } else {
+            std::printf("%8d %10zu %12s %12.2f %12.2f %10s\n", count, battles, "-",
+                        single * 1e3, parallel * 1e3, "-");
+        }
+    }
+    return 0;
+}
\ No newline at end of file
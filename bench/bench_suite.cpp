@@ -0,0 +1,230 @@
+// Набор Google Benchmark для отслеживания регрессий между сборками: горячие
+// пути арены на фиксированных зёрнах. Базовая линия пишется в JSON
+// (цель bench_baseline), две линии сравнивает compare.py из Google Benchmark.
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "../include/arena.h"
+#include "../include/combat_visitor.h"
+#include "../include/console_observer.h"
+#include "../include/event_bus.h"
+#include "../include/factory.h"
+#include "../include/file_observer.h"
+
+namespace {
+
+const uint64_t kSeed = 42;
+
+// плотность как в bench_start_battle: ~1 NPC на 400 клеток
+int sideFor(int count) {
+    return std::max(100, static_cast<int>(std::sqrt(count * 400.0)));
+}
+
+void populate(Arena& arena, int count) {
+    arena.setSeed(kSeed);
+    arena.generateRandomNpcs(count, false);
+}
+
+// std::cout в никуда на время замера
+class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return traits_type::not_eof(c); }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+class SilenceCout {
+    public:
+        SilenceCout() : previous_(std::cout.rdbuf(&null_)) {}
+        ~SilenceCout() { std::cout.rdbuf(previous_); }
+
+    private:
+        NullBuffer null_;
+        std::streambuf* previous_;
+};
+
+class NullObserver : public Observer {
+    public:
+        void notify(const std::string&) override {}
+        void onBattle(const BattleEvent&, const BattleEventContext&) override {}
+};
+
+class NameContext : public BattleEventContext {
+    public:
+        std::string_view nameOf(NpcHandle npc) const override {
+            return npc.index % 2 ? "attacker_npc" : "defender_npc";
+        }
+};
+
+void BM_CreateFromString(benchmark::State& state) {
+    const std::vector<std::string> lines = {
+        "Dragon dragon_1 10 20", "Elf elf_1 35 70", "Druid druid_1 99 0"};
+    size_t i = 0;
+    for (auto _ : state) {
+        auto npc = NpcFactory::createFromString(lines[i++ % lines.size()]);
+        benchmark::DoNotOptimize(npc);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CreateFromString);
+
+void BM_CanKill(benchmark::State& state) {
+    std::vector<std::unique_ptr<Npc>> npcs;
+    const char* types[] = {"Dragon", "Elf", "Druid"};
+    for (int i = 0; i < 1024; ++i) {
+        npcs.push_back(NpcFactory::createNpc(types[i % 3], "npc_" + std::to_string(i), 0, 0));
+    }
+    CombatVisitor visitor;
+    size_t i = 0;
+    for (auto _ : state) {
+        bool kill = visitor.canKill(npcs[i & 1023].get(), npcs[(i * 7 + 1) & 1023].get());
+        benchmark::DoNotOptimize(kill);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CanKill);
+
+// аргументы: число NPC, формат (0 - текст, 1 - двоичный снимок)
+void BM_SaveToFile(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    const auto format = state.range(1) ? SaveFormat::Binary : SaveFormat::Text;
+    const std::string path = "bench_suite_save.dat";
+    Arena arena(sideFor(count), sideFor(count));
+    populate(arena, count);
+    for (auto _ : state) {
+        arena.saveToFile(path, format);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_SaveToFile)->ArgsProduct({{1000, 100000}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+void BM_LoadFromFile(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    const auto format = state.range(1) ? SaveFormat::Binary : SaveFormat::Text;
+    const std::string path = "bench_suite_load.dat";
+    {
+        Arena source(sideFor(count), sideFor(count));
+        populate(source, count);
+        source.saveToFile(path, format);
+    }
+    Arena arena(sideFor(count), sideFor(count));
+    for (auto _ : state) {
+        state.PauseTiming();
+        arena.clear();
+        state.ResumeTiming();
+        LoadReport report = arena.loadFromFile(path);
+        benchmark::DoNotOptimize(report);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_LoadFromFile)->ArgsProduct({{1000, 100000}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+// startBattle удаляет погибших, поэтому мир строится заново перед каждым замером
+void BM_StartBattle(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    Arena arena(sideFor(count), sideFor(count));
+    arena.setWorkerThreads(1);
+    for (auto _ : state) {
+        state.PauseTiming();
+        arena.clear();
+        populate(arena, count);
+        state.ResumeTiming();
+        arena.startBattle(10.0);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_StartBattle)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
+
+// Шаг потока движения: перемещение и поиск боёв. Найденные бои разрешаются
+// вне замера, как потоками боёв в игре, чтобы каждый тик видел обычную очередь;
+// когда погибает половина NPC, мир строится заново
+void BM_Tick(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    Arena arena(sideFor(count), sideFor(count));
+    arena.setWorkerThreads(1);
+    populate(arena, count);
+    for (auto _ : state) {
+        arena.tick();
+        state.PauseTiming();
+        arena.drainBattles(1);
+        if (arena.getAliveCount() < static_cast<size_t>(count) / 2) {
+            arena.clear();
+            populate(arena, count);
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Tick)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
+
+// аргумент: 0 - кадр целиком, 1 - только изменившиеся клетки; мир двигается между кадрами
+void BM_PrintMap(benchmark::State& state) {
+    SilenceCout silence;
+    Arena arena(MAX_WIDTH, MAX_HEIGHT);
+    arena.setMapRenderMode(state.range(0) ? MapRenderer::Mode::Diff : MapRenderer::Mode::Full);
+    populate(arena, 50);
+    for (auto _ : state) {
+        state.PauseTiming();
+        arena.tick();
+        arena.drainBattles(1);
+        state.ResumeTiming();
+        arena.printMap();
+    }
+}
+BENCHMARK(BM_PrintMap)->Arg(0)->Arg(1);
+
+// Доставка итога боя наблюдателю тем же путём, что Arena::notifyObservers:
+// шина без диспетчера отдаёт событие сразу
+template <typename Make>
+void benchNotify(benchmark::State& state, Make make) {
+    SilenceCout silence;
+    NameContext context;
+    EventBus bus;
+    bus.setBattleContext(&context);
+    std::shared_ptr<Observer> observer = make();
+    bus.addObserver(observer);
+
+    BattleEvent event;
+    event.attacker = {1, 0};
+    event.defender = {2, 0};
+    event.attacker_type = NpcType::Dragon;
+    event.defender_type = NpcType::Elf;
+    event.attacker_attack = 5;
+    event.defender_defense = 2;
+    for (auto _ : state) {
+        event.tick++;
+        bus.publish(event);
+    }
+    observer->flush();
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_NotifyNull(benchmark::State& state) {
+    benchNotify(state, [] { return std::make_shared<NullObserver>(); });
+}
+BENCHMARK(BM_NotifyNull);
+
+void BM_NotifyConsole(benchmark::State& state) {
+    benchNotify(state, [] { return std::make_shared<ConsoleObserver>(); });
+}
+BENCHMARK(BM_NotifyConsole);
+
+void BM_NotifyFile(benchmark::State& state) {
+    const std::string path = "bench_suite_events.log";
+    std::remove(path.c_str());
+    benchNotify(state, [&] { return std::make_shared<FileObserver>(path); });
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_NotifyFile);
+
+}
+
+BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,170 @@
+// Бенчмарк тика: количество тиков в секунду в зависимости от числа NPC,
+// поиск пар через сетку против полного перебора O(N^2) и скорость
+// детерминированного прогона без пауз, масштабирование движения по ядрам.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../include/arena.h"
+#include "../include/spatial_grid.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void benchArenaTicks() {
+    std::printf("Arena::tick on 100x100 map\n");
+    std::printf("%10s %14s\n", "npcs", "ticks/sec");
+
+    for (int count : {50, 100, 200, 400, 800}) {
+        Arena arena(100, 100);
+        std::mt19937 gen(count);
+        std::uniform_int_distribution<> coord(0, 100);
+        const char* types[] = {"Dragon", "Elf", "Druid"};
+        for (int i = 0; i < count; ++i) {
+            arena.createAndAddNpc(types[i % 3], "npc_" + std::to_string(i), coord(gen), coord(gen));
+        }
+
+        const int ticks = 10;
+        auto start = Clock::now();
+        for (int i = 0; i < ticks; ++i) {
+            arena.tick();
+        }
+        std::printf("%10d %14.1f\n", count, ticks / secondsSince(start));
+    }
+}
+
+void benchPairSearch() {
+    std::printf("\nPair search on 4000x4000 world, radius 50\n");
+    std::printf("%10s %14s %14s %10s\n", "npcs", "grid/sec", "naive/sec", "pairs");
+
+    const int world = 4000;
+    const int radius = 50;
+
+    for (int count : {1000, 2000, 4000, 8000}) {
+        std::mt19937 gen(count);
+        std::uniform_int_distribution<> coord(0, world);
+        std::vector<SpatialGrid::Entry> entries;
+        for (int i = 0; i < count; ++i) {
+            entries.push_back({coord(gen), coord(gen), static_cast<uint32_t>(i)});
+        }
+
+        SpatialGrid grid;
+        size_t gridPairs = 0;
+        const int rounds = 10;
+        auto start = Clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            gridPairs = 0;
+            grid.rebuild(radius, entries);
+            grid.forEachCandidatePair([&](const SpatialGrid::Entry& a, const SpatialGrid::Entry& b) {
+                int dx = a.x - b.x;
+                int dy = a.y - b.y;
+                if (dx * dx + dy * dy <= radius * radius) gridPairs++;
+            });
+        }
+        double gridRate = rounds / secondsSince(start);
+
+        size_t naivePairs = 0;
+        start = Clock::now();
+        for (size_t i = 0; i < entries.size(); ++i) {
+            for (size_t j = i + 1; j < entries.size(); ++j) {
+                int dx = entries[i].x - entries[j].x;
+                int dy = entries[i].y - entries[j].y;
+                if (dx * dx + dy * dy <= radius * radius) naivePairs++;
+            }
+        }
+        double naiveRate = 1.0 / secondsSince(start);
+
+        if (naivePairs != gridPairs) {
+            std::printf("pair count mismatch: %zu vs %zu\n", gridPairs, naivePairs);
+        }
+        std::printf("%10d %14.1f %14.1f %10zu\n", count, gridRate, naiveRate, gridPairs);
+    }
+}
+
+}
+
+void benchHeadless() {
+    std::printf("\nArena::runHeadless, 100x100 map, 1000 ticks\n");
+    std::printf("%10s %14s %22s\n", "npcs", "ticks/sec", "sim seconds/real sec");
+
+    const double tickSeconds = std::chrono::duration<double>(Arena::kTickInterval).count();
+    for (int count : {50, 200, 800}) {
+        Arena arena(100, 100);
+        arena.setSeed(count);
+        arena.generateRandomNpcs(count, false);
+
+        const int ticks = 1000;
+        auto start = Clock::now();
+        arena.runHeadless(ticks);
+        double rate = ticks / secondsSince(start);
+        std::printf("%10d %14.1f %22.1f\n", count, rate, rate * tickSeconds);
+    }
+}
+
+void benchLargeWorld() {
+    // при одинаковой плотности время тика должно расти с числом NPC, а не с площадью
+    std::printf("\nArena::tick on large maps, ~1 NPC per 10000 cells\n");
+    std::printf("%10s %10s %14s %14s\n", "side", "npcs", "ticks/sec", "us/npc");
+
+    for (int side : {10000, 31623, 100000}) {
+        const int count = static_cast<int>(static_cast<long long>(side) * side / 10000);
+        Arena arena(side, side);
+        arena.setSeed(side);
+        arena.generateRandomNpcs(count, false);
+
+        const int ticks = 5;
+        auto start = Clock::now();
+        for (int i = 0; i < ticks; ++i) {
+            arena.tick();
+            arena.drainBattles(1);
+        }
+        double seconds = secondsSince(start);
+        std::printf("%10d %10d %14.2f %14.3f\n", side, count, ticks / seconds,
+                    seconds * 1e6 / ticks / count);
+    }
+}
+
+void benchParallelMovement() {
+    // радиус боя мал по сравнению с плотностью, так что тик - в основном движение
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("\nArena::tick by worker threads, ~1 NPC per 10000 cells, %u cores\n", cores);
+    std::printf("%10s %8s %14s %10s\n", "npcs", "threads", "ms/tick", "speedup");
+
+    for (int count : {100000, 1000000}) {
+        const int side = static_cast<int>(std::sqrt(count * 10000.0));
+        double base = 0;
+        for (unsigned threads = 1; threads <= cores; threads *= 2) {
+            Arena arena(side, side);
+            arena.setSeed(count);
+            arena.setWorkerThreads(threads);
+            arena.generateRandomNpcs(count, false);
+
+            const int ticks = 5;
+            auto start = Clock::now();
+            for (int i = 0; i < ticks; ++i) {
+                arena.tick();
+                arena.drainBattles(1);
+            }
+            double perTick = secondsSince(start) / ticks;
+            if (threads == 1) base = perTick;
+            std::printf("%10d %8u %14.2f %9.2fx\n", count, threads, perTick * 1e3, base / perTick);
+        }
+    }
+}
+
+int main() {
+    benchArenaTicks();
+    benchPairSearch();
+    benchHeadless();
+    benchLargeWorld();
+    benchParallelMovement();
+    return 0;
+}
\ No newline at end of file
@@ -4,23 +4,34 @@
 #include <memory>
 #include <vector>
 #include <shared_mutex>
-#include <queue>
 #include <atomic>
 #include <thread>
 #include <condition_variable>
+#include <chrono>
 #include "npc.h"
+#include "npc_store.h"
 #include "observer.h"
+#include "event_bus.h"
+#include "spatial_grid.h"
+#include "battle_queue.h"
+#include "map_renderer.h"
+#include "thread_pool.h"
+#include "npc_loader.h"
+#include "snapshot_publisher.h"
+#include "world_snapshot.h"
+#include "tick_pipeline.h"
+#include "metrics.h"
 
+// размер арены по умолчанию и наибольшее окно карты для printMap
 #define MAX_WIDTH 100
 #define MAX_HEIGHT 100
 
-struct BattleTask {
-    Npc* attacker;
-    Npc* defender;
-};
-
 class Arena {
     public:
+        // Наибольшая координата: y хранится в 31 бите NpcState.
+        // Память под мир зависит от числа NPC, а не от площади
+        static constexpr int kMaxCoordinate = (1 << 30) - 1;
+
         Arena(int width = MAX_WIDTH, int height = MAX_HEIGHT);
         ~Arena();
 
@@ -30,50 +41,216 @@ class Arena {
 
         size_t getNpcCount() const;
         size_t getAliveCount() const;
+        // указатели действительны до удаления NPC (startBattle, clear)
         std::vector<Npc*> getAliveNpcs() const;
 
+        // Последний опубликованный снимок мира; чтение не блокирует арену.
+        // Во время игры обновляется каждый тик, вне игры - при первом чтении
+        // после изменений
+        SnapshotPublisher<WorldSnapshot>::Guard snapshot() const;
+
         void addObserver(std::shared_ptr<Observer> observer);
         void removeObserver(std::shared_ptr<Observer> observer);
+        // Как часто диспетчер событий отдаёт наблюдателям накопленное во время игры
+        void setEventFlushInterval(std::chrono::milliseconds interval);
 
+        // Мгновенная битва всех со всеми на расстоянии range: пары ищутся по
+        // сетке (при большом числе NPC - на пуле потоков), события выходят
+        // в порядке слотов, погибшие удаляются после рассылки событий
         void startBattle(double range);
-        void saveToFile(const std::string& filename) const;
-        void loadFromFile(const std::string& filename);
+        // Размер пула для параллельных этапов (0 - по числу ядер), только вне игры
+        void setWorkerThreads(size_t threads);
+        // текстовый формат не хранит флаг жизни, поэтому погибшие в него не попадают
+        void saveToFile(const std::string& filename, SaveFormat format = SaveFormat::Text) const;
+        // Добавляет NPC из файла любого формата под одной блокировкой. Ошибочные
+        // строки (разбор, границы карты, повтор имени) пропускаются и попадают
+        // в отчёт; исключение - если файл не открыть или двоичный снимок повреждён
+        LoadReport loadFromFile(const std::string& filename);
+        // Восстанавливает арену из каталога Checkpointer: NPC, зерно и номер тика.
+        // Только вне игры; ошибки дельт попадают в отчёт с номером точки
+        LoadReport restoreCheckpoint(const std::string& directory);
         void clear();
 
-        void startGame(int durationSeconds = 30);
+        // Игра на конвейере тиков (tick_pipeline.h): движение следующего тика идёт
+        // одновременно с боями текущего, printMap выводит последний завершённый тик.
+        // battleWorkers - количество потоков, разрешающих бои
+        void startGame(int durationSeconds = 30, int battleWorkers = 1);
         void stopGame();
-        void generateRandomNpcs(int count);
+        // расстановка зависит только от зерна арены и числа уже добавленных NPC
+        void generateRandomNpcs(int count, bool printStats = true);
         void printMap() const;
+        // Full - кадр целиком одной записью, Diff - только изменившиеся клетки
+        void setMapRenderMode(MapRenderer::Mode mode);
+        // Часть мира, которую выводит printMap; по умолчанию левый нижний угол
+        // размером не больше MAX_WIDTH x MAX_HEIGHT
+        void setMapViewport(int x, int y, int width, int height);
+        int getWidth() const { return width_; }
+        int getHeight() const { return height_; }
         void printSurvivors() const;
 
-        std::thread& getMovementThread() { return movement_thread_; }
-        std::thread& getBattleThread() { return battle_thread_; }
+        // Один шаг симуляции: передвижение и поиск боёв
+        void tick();
+        // Длительность шага симуляции в реальном времени
+        static constexpr std::chrono::milliseconds kTickInterval{100};
+
+        // Главное зерно: от него зависят расстановка, ходы NPC и броски кубика.
+        // По умолчанию случайное; менять только вне игры
+        void setSeed(uint64_t seed);
+        uint64_t getSeed() const { return seed_; }
+        // Прогон ticks шагов без пауз и потоков: бои каждого шага разрешаются
+        // сразу в порядке обнаружения. Одинаковые зерно и расстановка дают
+        // одинаковый результат. Возвращает число разрешённых боёв
+        size_t runHeadless(uint64_t ticks);
+        // Задаёт число очередей боёв (по одной на поток), только вне игры
+        void setBattleWorkers(int workers);
+        // Ёмкость очереди боёв и поведение при переполнении, только вне игры
+        void configureBattleQueue(const BattleQueueConfig& config);
+        // Разрешает все накопленные бои workers потоками, возвращает число задач
+        size_t drainBattles(int workers);
+        uint64_t getTickCount() const { return tick_count_.load(std::memory_order_relaxed); }
+        size_t getPendingBattles() const { return battle_queue_->size(); }
+        BattleQueueStats getBattleQueueStats() const { return battle_queue_->getStats(); }
+        // задержки стадий конвейера последней (или идущей) игры
+        PipelineStats getPipelineStats() const;
+        // Метрики арены: задержки фаз тика, ожидание npcs_mutex_ и очереди боёв,
+        // глубина очереди, убийства за тик. Накапливаются за всё время жизни арены
+        const MetricsRegistry& getMetrics() const { return metrics_registry_; }
+        // Фазы тика, глубина очереди и убийства за тик пишутся каждый
+        // kMetricsTickPeriod-й тик: на маленьких аренах тик короче сотни
+        // атомарных операций, и запись на каждом тике заметна
+        static constexpr uint64_t kMetricsTickPeriod = 16;
+        // куда записать метрики при остановке игры; пустое имя - никуда
+        void setMetricsOutput(const std::string& filename, MetricsFormat format = MetricsFormat::Prometheus);
+
+        std::vector<std::thread>& getBattleThreads() { return battle_threads_; }
         std::thread& getPrintThread() { return print_thread_; }
 
     private:
+        struct Metrics {
+            explicit Metrics(MetricsRegistry& registry);
+
+            Histogram& move;
+            Histogram& pair_scan;
+            Histogram& battle_wait;
+            Histogram& battle_queue_push;
+            Histogram& notify;
+            Histogram& print_lock;
+            Histogram& npcs_lock_wait;
+            Histogram& queue_depth;
+            Histogram& kills_per_tick;
+            Counter& ticks;
+            Counter& battles;
+            Counter& kills;
+            Gauge& alive;
+        };
+
         int width_;
         int height_;
-        std::map<std::string, std::unique_ptr<Npc>> npcs_;
+        NpcStore npcs_;
+
+        // имена NPC для событий боёв; диспетчер читает их под разделяемой блокировкой
+        class EventContext : public BattleEventContext {
+            public:
+                explicit EventContext(const Arena& arena) : arena_(arena) {}
+                std::string_view nameOf(NpcHandle npc) const override;
+                void lock() const override { arena_.npcs_mutex_.lock_shared(); }
+                void unlock() const override { arena_.npcs_mutex_.unlock_shared(); }
+            private:
+                const Arena& arena_;
+        };
 
-        std::vector<std::shared_ptr<Observer>> observers_;
+        // во время игры события доставляет поток-диспетчер
+        EventBus events_;
+        EventContext event_context_;
 
         mutable std::shared_mutex npcs_mutex_;
-        mutable std::mutex observers_mutex_;
         mutable std::mutex cout_mutex_;
         
-        std::queue<BattleTask> battle_queue_;
-        std::mutex battle_queue_mutex_;
-        std::condition_variable battle_cv_;
+        BattleQueueConfig battle_queue_config_;
+        std::unique_ptr<BattleQueue> battle_queue_;
 
         std::atomic<bool> running_;
+        std::atomic<uint64_t> tick_count_;
 
-        std::thread movement_thread_;
-        std::thread battle_thread_;
+        uint64_t seed_;
+
+        // используются только потоком движения (или вызывающим tick())
+        SpatialGrid grid_;
+        std::vector<SpatialGrid::Entry> grid_entries_;
+        // типы NPC в порядке ячеек grid_
+        std::vector<uint8_t> grid_types_;
+        std::vector<BattleTask> detected_battles_;
+
+        // Буферы между стадиями конвейера, по номеру тика & 1: бои, найденные
+        // движением, и позиции на конец движения, по которым строится кадр,
+        // пока следующий тик уже двигает NPC
+        struct TickBuffer {
+            uint64_t tick = 0;
+            uint64_t membership = 0;
+            std::vector<BattleTask> battles;
+            std::vector<NpcState::Value> states;
+        };
+        TickBuffer tick_buffers_[2];
+        std::unique_ptr<TickPipeline> pipeline_;
+        // стадия боёв ждёт, пока потоки боёв разрешат её задачи
+        std::mutex resolved_mutex_;
+        std::condition_variable resolved_cv_;
+        uint64_t battles_resolved_ = 0;
+
+        // буфер кадра карты переживает вызовы printMap
+        mutable MapRenderer renderer_;
+        mutable std::mutex render_mutex_;
+        std::atomic<MapRenderer::Mode> map_mode_;
+
+        // снимки мира для читателей; строит их тот, кто держит npcs_mutex_
+        mutable SnapshotPublisher<WorldSnapshot> snapshots_;
+        mutable std::mutex snapshot_mutex_;
+        mutable std::atomic<bool> snapshot_stale_;
+        // меняется при добавлении и удалении NPC
+        std::atomic<uint64_t> membership_version_;
+        mutable std::shared_ptr<const std::vector<std::string>> snapshot_names_;
+        mutable uint64_t snapshot_names_version_;
+
+        // пул для параллельных этапов, создаётся при первой надобности
+        std::unique_ptr<ThreadPool> worker_pool_;
+        std::mutex worker_pool_mutex_;
+        size_t worker_threads_ = 0;
+
+        // реестр объявлен до metrics_: ссылки metrics_ указывают в него
+        mutable MetricsRegistry metrics_registry_;
+        mutable Metrics metrics_;
+        // доставка событий замеряется каждое kMetricsEventPeriod-е событие потока
+        static constexpr uint32_t kMetricsEventPeriod = 64;
+        static bool isTimedTick(uint64_t tick) { return tick % kMetricsTickPeriod == 0; }
+        // замеряется ли текущий тик; только поток движения
+        bool timed_tick_ = false;
+        std::string metrics_output_;
+        MetricsFormat metrics_format_ = MetricsFormat::Prometheus;
+
+        std::vector<std::thread> battle_threads_;
         std::thread print_thread_;
 
-        void notifyObservers(const std::string& event);
-        void movementThreadFunc();
-        void battleThreadFunc();
+        ThreadPool& workerPool();
+        void insertRecords(const std::vector<NpcRecord>& records, LoadReport& report);
+        void notifyObservers(const BattleEvent& event);
+        // перед удалением NPC: события о них должны получить свои имена
+        void deliverPendingEvents();
+        void moveStage(uint64_t tick);
+        void combatStage(uint64_t tick);
+        void publishStage(uint64_t tick);
+        void battleThreadFunc(size_t workerId);
         void printThreadFunc(int durationSeconds);
+        // вызываются под разделяемой блокировкой npcs_mutex_
+        void moveNpcs();
+        // движение слотов [first, last), не больше kMovementChunk
+        void moveRange(uint32_t first, uint32_t last, uint64_t tick);
+        void detectBattles();
+        void collectBattles(uint64_t tick, std::vector<BattleTask>& battles);
+        void resolveBattle(const BattleTask& task);
+
+        size_t processBattles(size_t workerId);
         bool isValidPosition(int x, int y) const;
+        // вызывается под разделяемой блокировкой npcs_mutex_; frame - позиции
+        // из буфера конвейера вместо текущих
+        void publishSnapshot(bool onlyIfStale = false, const TickBuffer* frame = nullptr) const;
 };
\ No newline at end of file
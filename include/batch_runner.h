@@ -0,0 +1,73 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "npc_type.h"
+
+// Среднее и дисперсия за один проход (алгоритм Уэлфорда);
+// частичные результаты потоков объединяются через merge.
+class RunningStats {
+    public:
+        void add(double value);
+        void merge(const RunningStats& other);
+
+        size_t count() const { return count_; }
+        double mean() const { return mean_; }
+        // несмещённая выборочная дисперсия
+        double variance() const { return count_ > 1 ? m2_ / (count_ - 1) : 0.0; }
+        double min() const { return min_; }
+        double max() const { return max_; }
+
+    private:
+        size_t count_ = 0;
+        double mean_ = 0.0;
+        double m2_ = 0.0;
+        double min_ = 0.0;
+        double max_ = 0.0;
+};
+
+struct BatchConfig {
+    size_t simulations = 1000;
+    // симуляция i идёт с зерном base_seed + i и воспроизводится отдельно
+    uint64_t base_seed = 1;
+    int width = 100;
+    int height = 100;
+    int npc_count = 50;
+    // 300 шагов по 100 мс - те же 30 секунд, что и у startGame
+    uint64_t ticks = 300;
+    // 0 - по числу аппаратных потоков
+    size_t threads = 0;
+};
+
+struct TypeSurvival {
+    RunningStats survivors;
+    // histogram[k] - в скольких симуляциях выжило ровно k NPC этого типа
+    std::vector<size_t> histogram;
+};
+
+struct BatchResult {
+    size_t simulations = 0;
+    std::array<TypeSurvival, kNpcTypeCount> by_type;
+    RunningStats total_survivors;
+    RunningStats battles;
+    double seconds = 0.0;
+
+    void merge(const BatchResult& other);
+};
+
+// Много независимых арен в режиме runHeadless на пуле потоков.
+// У каждой симуляции своя арена и своё зерно, общего состояния нет:
+// потоки копят статистику отдельно и объединяют её в конце.
+class BatchRunner {
+    public:
+        explicit BatchRunner(const BatchConfig& config);
+
+        BatchResult run() const;
+        const BatchConfig& getConfig() const { return config_; }
+
+    private:
+        BatchConfig config_;
+
+        void runOne(size_t index, BatchResult& result) const;
+};
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "npc_store.h"
+
+enum class BattleOutcome : uint8_t {
+    AttackerWon,
+    DefenderWon,
+    BothDied
+};
+
+// Итог боя в виде простой записи без строк: бой не выделяет память,
+// текст собирают только наблюдатели, которым он нужен.
+struct BattleEvent {
+    uint64_t tick = 0;
+    NpcHandle attacker;
+    NpcHandle defender;
+    NpcType attacker_type = NpcType::Unknown;
+    NpcType defender_type = NpcType::Unknown;
+    // броски кубика сторон; 0 - бросков не было (startBattle)
+    uint8_t attacker_attack = 0;
+    uint8_t attacker_defense = 0;
+    uint8_t defender_attack = 0;
+    uint8_t defender_defense = 0;
+    BattleOutcome outcome = BattleOutcome::AttackerWon;
+};
+
+static_assert(std::is_trivially_copyable<BattleEvent>::value,
+              "BattleEvent is copied through lock-free buffers");
+
+// Откуда наблюдатель берёт имена NPC для текста события.
+class BattleEventContext {
+    public:
+        virtual ~BattleEventContext() = default;
+
+        // пустая строка, если NPC уже удалён
+        virtual std::string_view nameOf(NpcHandle npc) const = 0;
+
+        // диспетчер событий держит контекст захваченным на время доставки пачки
+        virtual void lock() const {}
+        virtual void unlock() const {}
+};
+
+// Дописывает событие в out в формате прежних текстовых сообщений арены
+void appendBattleEvent(std::string& out, const BattleEvent& event, const BattleEventContext& context);
+std::string formatBattleEvent(const BattleEvent& event, const BattleEventContext& context);
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "npc_store.h"
+#include "pending_pair_set.h"
+#include "ring_buffer.h"
+
+struct BattleTask {
+    NpcHandle attacker;
+    NpcHandle defender;
+    // тик, на котором бой обнаружен; вместе с парой задаёт броски кубика
+    uint64_t tick = 0;
+};
+
+// Что делать с новой парой, если очередь потока боёв заполнена.
+// Повтор пары, бой которой ещё не разрешён, объединяется с ним при любой политике.
+enum class OverflowPolicy {
+    Drop,          // отбросить задачу
+    Backpressure   // ждать, пока потоки боёв освободят место
+};
+
+struct BattleQueueConfig {
+    size_t capacity = 1 << 14;
+    OverflowPolicy policy = OverflowPolicy::Backpressure;
+};
+
+struct BattleQueueStats {
+    size_t enqueued = 0;
+    size_t dropped = 0;
+    // повторы пар, у которых уже есть неразрешённый бой
+    size_t coalesced = 0;
+};
+
+// Очередь боёв: по ограниченному кольцевому буферу на поток боёв.
+// Поток берёт задачи из своего буфера, а когда он пуст - из чужих.
+// Память не растёт: общая ёмкость делится между буферами.
+// У каждой пары не больше одного неразрешённого боя: пара числится
+// ожидающей с постановки в очередь до вызова complete().
+//
+// Производитель один (поток движения), потребителей - сколько угодно.
+class BattleQueue {
+    public:
+        BattleQueue(size_t shards, const BattleQueueConfig& config);
+
+        // canWait - можно ли ждать места (false, когда потоки боёв не запущены)
+        bool push(const BattleTask& task, const std::atomic<bool>& canWait);
+        bool pop(size_t shard, BattleTask& task);
+        // бой разрешён: пару снова можно ставить в очередь
+        void complete(const BattleTask& task);
+        // выбрасывает все задачи из очереди, возвращает их число
+        size_t clear();
+
+        void notifyAll();
+        void waitForTasks(std::chrono::milliseconds timeout, const std::atomic<bool>& running);
+
+        size_t getShardCount() const { return shards_.size(); }
+        size_t size() const { return pending_.load(std::memory_order_acquire); }
+        size_t getCapacity() const;
+        const BattleQueueConfig& getConfig() const { return config_; }
+        BattleQueueStats getStats() const;
+
+    private:
+        BattleQueueConfig config_;
+        std::vector<std::unique_ptr<MpmcRingBuffer<BattleTask>>> shards_;
+        std::atomic<size_t> pending_;
+
+        std::atomic<size_t> enqueued_;
+        std::atomic<size_t> dropped_;
+        std::atomic<size_t> coalesced_;
+
+        PendingPairSet pending_pairs_;
+
+        std::mutex wait_mutex_;
+        std::condition_variable cv_;
+        // производитель ждёт места при Backpressure; pop() будит его, только
+        // если ожидающий есть
+        std::condition_variable space_cv_;
+        std::atomic<size_t> space_waiters_;
+
+        static uint64_t pairKey(const BattleTask& task);
+        size_t shardOf(const BattleTask& task) const;
+        bool waitForSpace(MpmcRingBuffer<BattleTask>& ring, const BattleTask& task,
+                          const std::atomic<bool>& canWait);
+};
\ No newline at end of file
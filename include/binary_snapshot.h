@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "npc_loader.h"
+
+// Двоичный формат сохранения, версия 1 (порядок байт - little-endian):
+//   заголовок BinarySnapshotHeader, 32 байта;
+//   count записей BinaryNpcRecord по 16 байт (alive: 0 - мёртв, 1 - жив,
+//   2 - удалён; последнее только в дельтах контрольных точек);
+//   таблица имён - имена подряд, без разделителей.
+// Контрольная сумма считается по записям и таблице имён. Записи выровнены,
+// поэтому при загрузке читаются прямо из отображённого в память файла.
+
+constexpr char kBinarySnapshotMagic[8] = {'L', 'A', 'B', '7', 'N', 'P', 'C', '\0'};
+constexpr uint32_t kBinarySnapshotVersion = 1;
+
+struct BinarySnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t names_bytes;
+    uint64_t checksum;
+};
+
+struct BinaryNpcRecord {
+    int32_t x;
+    int32_t y;
+    uint32_t name_offset;
+    uint16_t name_length;
+    uint8_t type;
+    uint8_t alive;
+};
+
+static_assert(sizeof(BinarySnapshotHeader) == 32, "header layout is part of the format");
+static_assert(sizeof(BinaryNpcRecord) == 16, "record layout is part of the format");
+
+// Собирает снимок в памяти и пишет его в файл тремя записями
+class BinarySnapshotWriter {
+    public:
+        explicit BinarySnapshotWriter(size_t expectedCount = 0);
+
+        void add(NpcType type, std::string_view name, int x, int y, bool alive);
+        // NPC удалён из арены с прошлой контрольной точки
+        void addRemoved(std::string_view name);
+        size_t size() const { return records_.size(); }
+        // бросает std::runtime_error, если файл не открыть или запись не удалась
+        void write(const std::string& filename) const;
+
+    private:
+        static constexpr uint8_t kRemoved = 2;
+
+        std::vector<BinaryNpcRecord> records_;
+        std::string names_;
+};
+
+// начинается ли содержимое файла с заголовка двоичного формата
+bool isBinarySnapshot(std::string_view data);
+
+// Разбирает снимок. Повреждённый файл (заголовок, версия, размеры,
+// контрольная сумма) целиком отвергается std::runtime_error; записи
+// с неизвестным типом попадают в errors с номером записи вместо строки.
+// Возвращает число записей
+size_t parseBinarySnapshot(std::string_view data, std::vector<NpcRecord>& records, std::vector<LoadError>& errors);
+
+// контрольная сумма формата: 64-битное перемешивание по 8 байт
+uint64_t snapshotChecksum(const void* data, size_t size, uint64_t seed = 0);
\ No newline at end of file
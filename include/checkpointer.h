@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "npc_loader.h"
+#include "world_snapshot.h"
+
+class Arena;
+
+struct CheckpointConfig {
+    // каталог должен существовать
+    std::string directory;
+    std::chrono::milliseconds interval{1000};
+    // каждая full_every-я точка - полный снимок, остальные - дельты к предыдущей
+    size_t full_every = 10;
+};
+
+struct CheckpointStats {
+    uint64_t full = 0;
+    uint64_t deltas = 0;
+    uint64_t bytes = 0;
+    // неудачных записей в фоновом потоке
+    uint64_t failures = 0;
+    // время сериализации и записи последней точки
+    std::chrono::microseconds last_write{0};
+};
+
+// Фоновые контрольные точки идущей игры.
+// Состояние берётся из опубликованного снимка мира (Arena::snapshot), поэтому
+// потоки движения и боёв не останавливаются: захват - это чтение указателя,
+// сериализация и запись идут в потоке контрольных точек.
+//
+// В каталоге лежат файлы checkpoint_<номер>.bin в двоичном формате
+// (binary_snapshot.h): полный снимок или дельта - изменившиеся, новые и удалённые
+// NPC относительно предыдущей точки. manifest.txt перечисляет зерно, последний
+// полный снимок и его дельты; он подменяется переименованием только после записи
+// файла точки, так что оборванная запись не портит уже сохранённое.
+class Checkpointer {
+    public:
+        Checkpointer(const Arena& arena, CheckpointConfig config);
+        ~Checkpointer();
+
+        Checkpointer(const Checkpointer&) = delete;
+        Checkpointer& operator=(const Checkpointer&) = delete;
+
+        // поток, пишущий точку каждые interval, до stop()
+        void start();
+        // останавливает поток и записывает последнюю точку
+        void stop();
+        // записать точку сейчас в вызывающем потоке
+        void checkpointNow();
+
+        CheckpointStats getStats() const;
+
+    private:
+        const Arena& arena_;
+        CheckpointConfig config_;
+
+        std::thread thread_;
+        std::atomic<bool> running_;
+        std::mutex wake_mutex_;
+        std::condition_variable wake_cv_;
+
+        // пишет только один поток за раз
+        mutable std::mutex write_mutex_;
+        uint64_t sequence_ = 0;
+        uint64_t last_full_ = 0;
+        std::vector<std::string> manifest_;
+        // предыдущая точка для дельт: записи в порядке слотов и их имена
+        std::vector<WorldSnapshot::Entry> previous_;
+        std::shared_ptr<const std::vector<std::string>> previous_names_;
+        CheckpointStats stats_;
+
+        void threadFunc();
+        void writeManifest(const std::vector<std::string>& manifest) const;
+        void removeOlderThan(uint64_t sequence) const;
+};
+
+// Состояние из каталога контрольных точек: полный снимок с применёнными дельтами
+struct CheckpointData {
+    uint64_t seed = 0;
+    uint64_t tick = 0;
+    size_t bytes = 0;
+    // имена records указывают в эти файлы
+    std::vector<std::unique_ptr<MappedFile>> files;
+    std::vector<NpcRecord> records;
+    // errors - дельты, которые не удалось применить (номер точки вместо строки)
+    std::vector<LoadError> errors;
+};
+
+// бросает std::runtime_error, если нет манифеста или полного снимка
+CheckpointData readCheckpoint(const std::string& directory);
\ No newline at end of file
@@ -2,20 +2,14 @@
 #include "visitor.h"
 #include "npc.h"
 
+// Правила боя задаёт таблица kKillMatrix по типам NPC. Двойная диспетчеризация
+// через accept для боя не нужна: тип известен с момента создания NPC.
 class CombatVisitor : public Visitor {
     public:
         // Метод: может ли атакующий убить защищающегося?
-        bool canKill(Npc* attacker, Npc* defender);
+        bool canKill(const Npc* attacker, const Npc* defender) const;
 
         void visit(Dragon&) override {}
         void visit(Elf&) override {}
         void visit(Druid&) override {}
-    
-    private:
-        // Дракон нападает на эльфов
-        bool dragonVs(const std::string& defenderType);
-        // Эльф нападает на друидов
-        bool elfVs(const std::string& defenderType);
-        // Друид нападает на драконов
-        bool druidVs(const std::string& defenderType);
 };
\ No newline at end of file
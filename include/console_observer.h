@@ -7,4 +7,28 @@ class ConsoleObserver : public Observer {
         void notify(const std::string& event) override {
             std::cout << event << std::endl;
         }
+
+        // вся пачка одной записью и одним сбросом буфера
+        void notifyBatch(const std::vector<std::string>& events) override {
+            std::string text;
+            for (const auto& event : events) {
+                text += event;
+                text += '\n';
+            }
+            std::cout << text << std::flush;
+        }
+
+        void onBattle(const BattleEvent& event, const BattleEventContext& context) override {
+            onBattleBatch({event}, context);
+        }
+
+        // текст событий собирается прямо в общий буфер вывода
+        void onBattleBatch(const std::vector<BattleEvent>& events, const BattleEventContext& context) override {
+            std::string text;
+            for (const auto& event : events) {
+                appendBattleEvent(text, event, context);
+                text += '\n';
+            }
+            std::cout << text << std::flush;
+        }
 };
\ No newline at end of file
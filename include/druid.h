@@ -4,7 +4,8 @@
 
 class Druid : public Npc {
     public:
-        Druid(int x, int y, const std::string& name);
+        Druid(int x, int y, std::string_view name,
+              std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
         void accept(Visitor& visitor) override;
 
@@ -12,7 +13,4 @@ class Druid : public Npc {
 
         int getMoveDistance() const override { return 10; }
         int getKillDistance() const override { return 10; }
-
-    private:
-        static const std::string kType;
 };
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "observer.h"
+#include "ring_buffer.h"
+
+// Асинхронная доставка событий наблюдателям.
+// Производители кладут события в lock-free буфер, отдельный поток-диспетчер
+// раз в flush interval (или при заполнении буфера наполовину) отдаёт
+// наблюдателям накопленное пачкой. stop() доставляет всё, что осталось.
+// Пока диспетчер не запущен, события доставляются синхронно.
+//
+// Итоги боёв идут отдельным буфером простых записей BattleEvent; имена для них
+// наблюдатели берут из контекста, который задаёт владелец шины.
+class EventBus {
+    public:
+        explicit EventBus(size_t capacity = 1 << 14);
+        ~EventBus();
+
+        EventBus(const EventBus&) = delete;
+        EventBus& operator=(const EventBus&) = delete;
+
+        void addObserver(std::shared_ptr<Observer> observer);
+        void removeObserver(const std::shared_ptr<Observer>& observer);
+
+        void publish(std::string event);
+        void publish(const BattleEvent& event);
+
+        // context должен жить дольше шины; без него имена NPC пустые
+        void setBattleContext(const BattleEventContext* context) { context_ = context; }
+        // ждёт, пока диспетчер доставит всё опубликованное ранее
+        void waitUntilDelivered();
+
+        void start();
+        void stop();
+        bool isRunning() const { return running_; }
+
+        void setFlushInterval(std::chrono::milliseconds interval) { flush_interval_ = interval; }
+        std::chrono::milliseconds getFlushInterval() const { return flush_interval_; }
+
+        size_t getPublishedCount() const { return published_; }
+        size_t getDeliveredCount() const { return delivered_; }
+        size_t getBatchCount() const { return batches_; }
+
+    private:
+        MpmcRingBuffer<std::string> queue_;
+        MpmcRingBuffer<BattleEvent> battles_;
+        const BattleEventContext* context_;
+
+        std::vector<std::shared_ptr<Observer>> observers_;
+        mutable std::mutex observers_mutex_;
+
+        std::atomic<bool> running_;
+        std::atomic<std::chrono::milliseconds> flush_interval_;
+        std::atomic<bool> flush_requested_;
+        std::thread dispatcher_;
+        std::mutex wait_mutex_;
+        std::condition_variable cv_;
+        // waitUntilDelivered ждёт, пока delivered_ догонит published_
+        std::mutex delivered_mutex_;
+        std::condition_variable delivered_cv_;
+
+        std::atomic<size_t> published_;
+        std::atomic<size_t> delivered_;
+        std::atomic<size_t> batches_;
+
+        void dispatcherThreadFunc();
+        void wakeDispatcher();
+        void notifyDelivered();
+        bool hasBacklog() const;
+        // забирает все события из буферов и доставляет их пачками
+        bool dispatchPending(std::vector<std::string>& batch, std::vector<BattleEvent>& battles);
+        void deliver(const std::vector<std::string>& batch, const std::vector<BattleEvent>& battles);
+};
\ No newline at end of file
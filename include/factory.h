@@ -12,5 +12,8 @@ class NpcFactory {
             int y
         );
         
+        // без разбора строки типа; nullptr для NpcType::Unknown
+        static std::unique_ptr<Npc> createNpc(NpcType type, const std::string& name, int x, int y);
+
         static std::unique_ptr<Npc> createFromString(const std::string& line);
 };
\ No newline at end of file
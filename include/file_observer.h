@@ -1,18 +1,68 @@
 #pragma once
 #include "observer.h"
+#include <chrono>
+#include <cstddef>
 #include <fstream>
+#include <mutex>
 #include <string>
 
+struct FileObserverConfig {
+    // при таком объёме накопленных данных буфер сбрасывается в файл
+    size_t buffer_size = 64 * 1024;
+    // данные не лежат в буфере дольше этого
+    std::chrono::milliseconds flush_interval{200};
+    // размер файла, после которого он ротируется; 0 - без ротации
+    size_t rotate_size = 0;
+    // сколько старых файлов хранить (filename.1 ... filename.N)
+    size_t max_rotated_files = 3;
+};
+
+struct FileObserverStats {
+    size_t bytes_written = 0;
+    size_t flushes = 0;
+    size_t rotations = 0;
+    std::chrono::nanoseconds last_flush_latency{0};
+    std::chrono::nanoseconds max_flush_latency{0};
+    std::chrono::nanoseconds total_flush_latency{0};
+};
+
+// Журнал событий в файл. Файл открыт всё время жизни наблюдателя,
+// события копятся в памяти и пишутся крупными блоками.
 class FileObserver : public Observer {
     public:
-        FileObserver(const std::string& filename) : filename(filename) {}
-        
-        void notify(const std::string& event) override {
-            std::ofstream file(filename, std::ios::app);
-            if (file.is_open()) {
-                file << event << std::endl;
-            }
-        }
-private:
-    std::string filename;
+        explicit FileObserver(const std::string& filename, FileObserverConfig config = {});
+        ~FileObserver() override;
+
+        FileObserver(const FileObserver&) = delete;
+        FileObserver& operator=(const FileObserver&) = delete;
+
+        void notify(const std::string& event) override;
+        void notifyBatch(const std::vector<std::string>& events) override;
+        void onBattle(const BattleEvent& event, const BattleEventContext& context) override;
+        void onBattleBatch(const std::vector<BattleEvent>& events, const BattleEventContext& context) override;
+        void poll() override;
+        void flush() override;
+
+        FileObserverStats getStats() const;
+        const std::string& getFilename() const { return filename_; }
+        const FileObserverConfig& getConfig() const { return config_; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        std::string filename_;
+        FileObserverConfig config_;
+        std::ofstream file_;
+        std::string buffer_;
+        size_t file_size_ = 0;
+        Clock::time_point last_flush_;
+        FileObserverStats stats_;
+        mutable std::mutex mutex_;
+
+        void append(const std::string& event);
+        void appendBattle(const BattleEvent& event, const BattleEventContext& context);
+        void flushIfDue();
+        void flushLocked();
+        void rotateLocked();
+        void open(std::ios::openmode mode);
 };
\ No newline at end of file
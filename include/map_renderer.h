@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Кадр карты для printMap. Буфер кадра живёт между вызовами: на каждом кадре
+// стираются только клетки, занятые в прошлый раз, и запоминается, какие
+// клетки изменились. Текст кадра собирается в одну строку, вывод - у вызывающего.
+// Кадр - окно width x height с левым нижним углом в (originX, originY):
+// карта может быть сколь угодно большой, память и время зависят только от окна.
+class MapRenderer {
+    public:
+        enum class Mode {
+            Full,  // весь кадр целиком
+            Diff   // после первого кадра - только изменившиеся клетки (ANSI)
+        };
+
+        MapRenderer(int width, int height, int originX = 0, int originY = 0);
+
+        // начинает новый кадр; plot и setCounts вызываются под блокировкой NPC,
+        // render - уже без неё
+        void beginFrame();
+        // координаты мира; точки вне окна пропускаются
+        void plot(int x, int y, char symbol);
+        void setCounts(size_t alive, size_t total);
+
+        const std::string& render(Mode mode);
+
+        // индексы клеток окна (y * (width + 1) + x), изменившихся с прошлого кадра
+        const std::vector<uint32_t>& getChangedCells() const { return changed_; }
+
+    private:
+        static constexpr char kEmpty = '.';
+
+        int width_;
+        int height_;
+        int origin_x_;
+        int origin_y_;
+        size_t columns_;
+        // ширина подписей строк, не меньше трёх цифр
+        int label_width_;
+
+        std::vector<char> frame_;
+        // что уже выведено на терминал
+        std::vector<char> shown_;
+        std::vector<uint32_t> plotted_;
+        std::vector<uint32_t> previous_;
+        std::vector<uint32_t> changed_;
+        bool screen_ready_ = false;
+
+        size_t alive_ = 0;
+        size_t total_ = 0;
+        std::string out_;
+
+        void collectChanges();
+        void renderFull();
+        void renderDiff();
+        void appendStatus();
+        // строка терминала для строки карты y при полном кадре, начиная с 1
+        int screenRow(int y) const { return 3 + (height_ - y); }
+        // столбец терминала для столбца карты x, начиная с 1
+        int screenColumn(int x) const { return label_width_ + 4 + x; }
+};
\ No newline at end of file
@@ -0,0 +1,197 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// Встроенные метрики: счётчики, значения и гистограммы с корзинами по
+// степеням двойки. Запись - несколько relaxed-атомарных операций без
+// блокировок, так что метрики можно обновлять из горячих путей любых потоков.
+//
+// Сборка с LAB7_ENABLE_METRICS=0 убирает запись целиком: макросы LAB7_METRIC_*
+// и lockTimed не трогают часов и атомиков, реестр и экспорт остаются, но все
+// значения нулевые.
+#ifndef LAB7_ENABLE_METRICS
+#define LAB7_ENABLE_METRICS 1
+#endif
+
+class Counter {
+    public:
+        void add(uint64_t value = 1) { value_.fetch_add(value, std::memory_order_relaxed); }
+        uint64_t get() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+    public:
+        void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+        int64_t get() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> value_{0};
+};
+
+// Корзина 0 - значение 0, корзина i - значения [2^(i-1), 2^i)
+class Histogram {
+    public:
+        static constexpr size_t kBuckets = 65;
+
+        void record(uint64_t value);
+
+        // сумма корзин: запись не тратит на счётчик отдельную атомарную операцию
+        uint64_t count() const;
+        uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+        uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+        uint64_t bucket(size_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
+        // верхняя граница корзины (включительно)
+        static uint64_t bucketLimit(size_t index);
+        // оценка сверху: граница корзины, в которой лежит квантиль q из [0, 1]
+        uint64_t quantile(double q) const;
+
+    private:
+        std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+        std::atomic<uint64_t> sum_{0};
+        std::atomic<uint64_t> max_{0};
+};
+
+enum class MetricsFormat {
+    Prometheus,
+    Json
+};
+
+// Реестр именованных метрик. Регистрация - при создании владельца, дальше
+// горячие пути работают по сохранённым ссылкам; ссылки не меняются до
+// уничтожения реестра.
+class MetricsRegistry {
+    public:
+        // scale - множитель для экспорта (наносекунды в секунды: 1e-9)
+        Histogram& histogram(std::string name, std::string help, double scale = 1.0);
+        Counter& counter(std::string name, std::string help);
+        Gauge& gauge(std::string name, std::string help);
+
+        const Histogram* findHistogram(std::string_view name) const;
+        const Counter* findCounter(std::string_view name) const;
+        const Gauge* findGauge(std::string_view name) const;
+
+        // текстовый формат Prometheus: _bucket{le=...}, _sum, _count для гистограмм
+        std::string toPrometheus() const;
+        std::string toJson() const;
+        // бросает std::runtime_error, если файл не записать
+        void write(const std::string& filename, MetricsFormat format) const;
+
+    private:
+        enum class Kind { Counter, Gauge, Histogram };
+        struct Entry {
+            Kind kind;
+            std::string name;
+            std::string help;
+            double scale;
+            Counter* counter;
+            Gauge* gauge;
+            Histogram* histogram;
+        };
+
+        mutable std::mutex mutex_;
+        // deque не перемещает элементы при добавлении
+        std::deque<Counter> counters_;
+        std::deque<Gauge> gauges_;
+        std::deque<Histogram> histograms_;
+        std::deque<Entry> entries_;
+
+        const Entry* find(std::string_view name, Kind kind) const;
+};
+
+// Время жизни объекта в наносекундах попадает в гистограмму; неактивный
+// таймер не читает часы
+class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram& histogram, bool active = true)
+            : histogram_(active ? &histogram : nullptr) {
+            if (histogram_) start_ = std::chrono::steady_clock::now();
+        }
+        ~ScopedTimer() {
+            if (!histogram_) return;
+            histogram_->record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_).count()));
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Histogram* histogram_;
+        std::chrono::steady_clock::time_point start_;
+};
+
+// Замер идущих подряд фаз: lap() записывает время с прошлой отметки.
+// Деструктора нет, поэтому замер не мешает оптимизировать горячие функции;
+// неактивный замер не читает часы
+class PhaseTimer {
+    public:
+        explicit PhaseTimer([[maybe_unused]] bool active) {
+#if LAB7_ENABLE_METRICS
+            active_ = active;
+            if (active_) last_ = std::chrono::steady_clock::now();
+#endif
+        }
+
+        void lap([[maybe_unused]] Histogram& histogram) {
+#if LAB7_ENABLE_METRICS
+            if (!active_) return;
+            const auto now = std::chrono::steady_clock::now();
+            histogram.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_).count()));
+            last_ = now;
+#endif
+        }
+
+    private:
+        bool active_ = false;
+        std::chrono::steady_clock::time_point last_;
+};
+
+// Захват блокировки с записью времени ожидания. Свободная блокировка
+// берётся без часов и не записывается: в гистограмме только ожидания
+template <typename Lock>
+void lockTimed(Lock& lock, [[maybe_unused]] Histogram& wait) {
+#if LAB7_ENABLE_METRICS
+    if (lock.try_lock()) return;
+    const auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    wait.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count()));
+#else
+    lock.lock();
+#endif
+}
+
+#define LAB7_METRIC_CONCAT_(a, b) a##b
+#define LAB7_METRIC_CONCAT(a, b) LAB7_METRIC_CONCAT_(a, b)
+
+// LAB7_METRIC_TIME_IF - замер, только если condition истинно;
+// LAB7_METRIC_TIME_SAMPLED - каждый period-й проход (степень двойки) в каждом потоке
+#if LAB7_ENABLE_METRICS
+#define LAB7_METRIC_TIME(histogram) ScopedTimer LAB7_METRIC_CONCAT(lab7_timer_, __LINE__)(histogram)
+#define LAB7_METRIC_TIME_IF(histogram, condition) \
+    ScopedTimer LAB7_METRIC_CONCAT(lab7_timer_, __LINE__)((histogram), (condition))
+#define LAB7_METRIC_TIME_SAMPLED(histogram, period) \
+    static thread_local uint32_t LAB7_METRIC_CONCAT(lab7_sample_, __LINE__) = 0; \
+    ScopedTimer LAB7_METRIC_CONCAT(lab7_timer_, __LINE__)( \
+        (histogram), (LAB7_METRIC_CONCAT(lab7_sample_, __LINE__)++ & ((period) - 1)) == 0)
+#define LAB7_METRIC_RECORD(histogram, value) (histogram).record(value)
+#define LAB7_METRIC_ADD(counter, value) (counter).add(value)
+#define LAB7_METRIC_SET(gauge, value) (gauge).set(value)
+#else
+#define LAB7_METRIC_TIME(histogram) ((void)0)
+#define LAB7_METRIC_TIME_IF(histogram, condition) ((void)0)
+#define LAB7_METRIC_TIME_SAMPLED(histogram, period) ((void)0)
+#define LAB7_METRIC_RECORD(histogram, value) ((void)0)
+#define LAB7_METRIC_ADD(counter, value) ((void)0)
+#define LAB7_METRIC_SET(gauge, value) ((void)0)
+#endif
\ No newline at end of file
@@ -1,19 +1,28 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <memory>
-#include <mutex>
+#include <memory_resource>
+#include <cstdint>
+#include "npc_state.h"
+#include "npc_type.h"
 
 class Visitor;
+class NpcStore;
 
 class Npc {
     public:
-        Npc(int x, int y, const std::string& type, const std::string& name);
+        // resource - откуда берётся память под имя (у NPC из NpcPool - из пула)
+        Npc(int x, int y, NpcType type, std::string_view name,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
         virtual ~Npc() = default;
         int getX() const;
         int getY() const;
-        std::string getType() const;
+        const std::string& getType() const;
+        NpcType getTypeId() const { return type_; }
         std::string getName() const;
+        std::string_view getNameView() const { return name_; }
 
         void setX(int x);
         void setY(int y);
@@ -28,18 +37,27 @@ class Npc {
         friend std::ostream& operator<<(std::ostream& os, const Npc& npc);
 
         bool isAlive() const;
-        void kill();
+        // возвращает true, если именно этот вызов убил NPC
+        bool kill();
 
         virtual int getMoveDistance() const = 0;
         virtual int getKillDistance() const = 0;
 
-    protected:
-        mutable std::mutex mutex_;
-
     private:
-        int x_;
-        int y_;
-        std::string type_;
-        std::string name_;
-        bool alive_;
-};
\ No newline at end of file
+        friend class NpcStore;
+
+        // после добавления в арену координаты и флаг жизни хранятся в NpcStore
+        NpcStore* store_ = nullptr;
+        uint32_t slot_ = 0;
+
+        NpcState state_;
+        NpcType type_;
+        std::pmr::string name_;
+
+        NpcState& state();
+        const NpcState& state() const;
+};
+
+// Строка "NPC: имя (тип) at (x, y) - Alive|Dead": общий формат operator<< и
+// списка выживших арены
+std::ostream& writeNpcLine(std::ostream& os, std::string_view name, NpcType type, int x, int y, bool alive);
\ No newline at end of file
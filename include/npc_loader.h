@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "npc_type.h"
+
+// Быстрая загрузка файлов сохранения формата "тип имя x y" по строке на NPC.
+// Файл отображается в память, числа разбираются std::from_chars, ошибки
+// строк собираются в отчёт вместо исключений.
+
+// формат saveToFile; loadFromFile определяет формат сам
+enum class SaveFormat {
+    Text,   // строки "тип имя x y"
+    Binary  // binary_snapshot.h
+};
+
+struct LoadError {
+    size_t line;  // с единицы; в двоичном формате - номер записи
+    std::string message;
+};
+
+struct LoadReport {
+    size_t bytes = 0;
+    size_t lines = 0;   // непустых строк (записей в двоичном формате)
+    size_t loaded = 0;  // добавлено NPC
+    std::vector<LoadError> errors;
+
+    bool ok() const { return errors.empty(); }
+};
+
+// Разобранная строка; name указывает в исходный текст
+struct NpcRecord {
+    NpcType type;
+    std::string_view name;
+    int x;
+    int y;
+    bool alive = true;
+    // только в дельтах контрольных точек: NPC удалён
+    bool removed = false;
+    size_t line;
+};
+
+// Файл, отображённый в память только для чтения
+class MappedFile {
+    public:
+        // бросает std::runtime_error, если файл не открыть
+        explicit MappedFile(const std::string& filename);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        std::string_view view() const { return {data_, size_}; }
+        size_t size() const { return size_; }
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+};
+
+// Разбирает весь текст; ошибочные строки попадают в errors.
+// Возвращает число непустых строк
+size_t parseNpcRecords(std::string_view text, std::vector<NpcRecord>& records, std::vector<LoadError>& errors);
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+#include "npc.h"
+
+// Пул объектов NPC: Dragon, Elf и Druid размещаются в монотонном буфере
+// крупными блоками. Уничтоженный объект попадает в список свободных своего типа
+// и переиспользуется следующим create. Длинные имена берутся из пула блоков
+// поверх того же буфера и при уничтожении NPC возвращаются в него, так что
+// поток создания и удаления не растит буфер без конца.
+// release() отдаёт всю память разом и не вызывает деструкторов: всё, чем
+// владеют объекты пула, лежит в том же буфере.
+// Не потокобезопасен: NpcStore вызывает его под эксклюзивной блокировкой.
+class NpcPool {
+    public:
+        explicit NpcPool(size_t initialBytes = 64 * 1024,
+                         std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+        NpcPool(const NpcPool&) = delete;
+        NpcPool& operator=(const NpcPool&) = delete;
+
+        // nullptr для NpcType::Unknown
+        Npc* create(NpcType type, std::string_view name, int x, int y);
+        void destroy(Npc* npc);
+        // все объекты пула становятся недействительными
+        void release();
+
+        size_t getLiveCount() const { return live_; }
+        // сколько create обошлись списком свободных
+        size_t getReusedCount() const { return reused_; }
+
+    private:
+        std::pmr::monotonic_buffer_resource resource_;
+        std::pmr::unsynchronized_pool_resource names_;
+        std::vector<void*> free_[kNpcTypeCount];
+        size_t live_ = 0;
+        size_t reused_ = 0;
+
+        template <typename T>
+        Npc* make(NpcType type, std::string_view name, int x, int y);
+};
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Координаты и флаг жизни NPC, упакованные в одно 64-битное слово.
+// Чтение никогда не блокируется и всегда даёт согласованную пару (x, y).
+//
+// Раскладка: биты 0-31 - x, биты 32-62 - y (знаковое 31-битное), бит 63 - жив.
+class NpcState {
+    public:
+        struct Value {
+            int x;
+            int y;
+            bool alive;
+        };
+
+        NpcState(int x = 0, int y = 0, bool alive = true) : word_(pack(x, y, alive)) {}
+        // копирование нужно для хранения в std::vector, выполняется под эксклюзивной блокировкой
+        NpcState(const NpcState& other) : word_(other.word_.load(std::memory_order_acquire)) {}
+        NpcState& operator=(const NpcState& other) {
+            word_.store(other.word_.load(std::memory_order_acquire), std::memory_order_release);
+            return *this;
+        }
+
+        Value load() const { return unpack(word_.load(std::memory_order_acquire)); }
+        int getX() const { return load().x; }
+        int getY() const { return load().y; }
+        bool isAlive() const { return (word_.load(std::memory_order_acquire) & kAliveBit) != 0; }
+
+        // меняет координаты, сохраняя флаг жизни (мёртвый NPC не оживает)
+        void setPosition(int x, int y) {
+            uint64_t current = word_.load(std::memory_order_relaxed);
+            while (!word_.compare_exchange_weak(current, pack(x, y, (current & kAliveBit) != 0),
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+            }
+        }
+
+        // возвращает true только тому вызывающему, который действительно убил NPC
+        bool kill() {
+            return (word_.fetch_and(~kAliveBit, std::memory_order_acq_rel) & kAliveBit) != 0;
+        }
+
+        void reset(int x, int y, bool alive) {
+            word_.store(pack(x, y, alive), std::memory_order_release);
+        }
+
+        static uint64_t pack(int x, int y, bool alive) {
+            return static_cast<uint64_t>(static_cast<uint32_t>(x)) |
+                   ((static_cast<uint64_t>(static_cast<uint32_t>(y)) & kYMask) << 32) |
+                   (alive ? kAliveBit : 0);
+        }
+
+        static Value unpack(uint64_t word) {
+            int x = static_cast<int32_t>(static_cast<uint32_t>(word));
+            // сдвиг влево и арифметический вправо восстанавливают знак y
+            int y = static_cast<int32_t>(static_cast<uint32_t>(word >> 31) & ~1u) >> 1;
+            return {x, y, (word & kAliveBit) != 0};
+        }
+
+    private:
+        static constexpr uint64_t kAliveBit = 1ull << 63;
+        static constexpr uint64_t kYMask = (1ull << 31) - 1;
+
+        std::atomic<uint64_t> word_;
+};
\ No newline at end of file
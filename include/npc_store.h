@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "npc.h"
+#include "npc_pool.h"
+#include "npc_state.h"
+
+// Устойчивый дескриптор NPC: индекс слота и его поколение.
+// Остаётся корректным при росте хранилища, после удаления NPC
+// перестаёт проходить проверку valid().
+struct NpcHandle {
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    uint32_t index = kInvalidIndex;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != kInvalidIndex; }
+    bool operator==(const NpcHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const NpcHandle& other) const { return !(*this == other); }
+};
+
+// Плотное хранилище NPC в виде структуры массивов: упакованное состояние
+// (координаты и флаг жизни), тип и дистанции лежат в непрерывных массивах,
+// имена - в отдельной таблице.
+// Слоты удалённых NPC переиспользуются с увеличением поколения.
+// Объекты, созданные через emplace, живут в собственном NpcPool; очистка
+// хранилища без объектов из кучи не обходит их, а только увеличивает поколения
+// слотов одним проходом по плотному массиву.
+//
+// Вставка, удаление и очистка меняют массивы и требуют эксклюзивной
+// блокировки; чтение и изменение отдельных слотов - разделяемой.
+class NpcStore {
+    public:
+        NpcStore() = default;
+        ~NpcStore();
+        NpcStore(const NpcStore&) = delete;
+        NpcStore& operator=(const NpcStore&) = delete;
+
+        NpcHandle insert(std::unique_ptr<Npc> npc);
+        // как insert, но при повторе имени возвращает недействительный дескриптор
+        NpcHandle tryInsert(std::unique_ptr<Npc> npc);
+        // создаёт NPC в пуле хранилища; при повторе имени или типе Unknown
+        // возвращает недействительный дескриптор
+        NpcHandle emplace(NpcType type, std::string_view name, int x, int y);
+        void erase(NpcHandle handle);
+        void clear();
+        // заранее выделяет место под count NPC всего
+        void reserve(size_t count);
+
+        // количество живых слотов (занятых NPC)
+        size_t size() const { return size_; }
+        // количество слотов для линейного обхода, включая свободные
+        uint32_t slotCount() const { return static_cast<uint32_t>(objects_.size()); }
+
+        bool occupied(uint32_t index) const { return objects_[index] != nullptr; }
+        bool valid(NpcHandle handle) const;
+        NpcHandle handleAt(uint32_t index) const { return {index, generations_[index]}; }
+        NpcHandle find(std::string_view name) const;
+
+        NpcState& getState(uint32_t index) { return states_[index]; }
+        const NpcState& getState(uint32_t index) const { return states_[index]; }
+        NpcState::Value loadState(uint32_t index) const { return states_[index].load(); }
+        int getX(uint32_t index) const { return states_[index].getX(); }
+        int getY(uint32_t index) const { return states_[index].getY(); }
+        bool isAlive(uint32_t index) const { return states_[index].isAlive(); }
+        NpcType getTypeId(uint32_t index) const { return types_[index]; }
+        int getMoveDistance(uint32_t index) const { return move_distances_[index]; }
+        int getKillDistance(uint32_t index) const { return kill_distances_[index]; }
+        // действительно, пока NPC в хранилище
+        std::string_view getName(uint32_t index) const { return names_[index]; }
+        Npc* getObject(uint32_t index) const { return objects_[index]; }
+
+        void setPosition(uint32_t index, int x, int y) { states_[index].setPosition(x, y); }
+        // возвращает true, если NPC был жив до вызова
+        bool kill(uint32_t index) { return states_[index].kill(); }
+
+    private:
+        std::vector<NpcState> states_;
+        std::vector<NpcType> types_;
+        std::vector<uint16_t> move_distances_;
+        std::vector<uint16_t> kill_distances_;
+        std::vector<uint32_t> generations_;
+
+        // имена указывают в сами объекты
+        std::vector<std::string_view> names_;
+        std::vector<Npc*> objects_;
+        // 1 - объект из pool_, 0 - из кучи (insert), удаляется через delete
+        std::vector<uint8_t> pooled_;
+        size_t heap_objects_ = 0;
+        NpcPool pool_;
+        // Индекс имён: открытая адресация с линейным пробированием, без узлов
+        // в куче. Запись хранит слот и младшие 32 бита хеша имени; сами имена
+        // лежат в names_. Удаление сдвигает хвост цепочки, надгробий нет
+        struct IndexEntry {
+            uint32_t slot;
+            uint32_t hash;
+        };
+        static constexpr uint32_t kNoSlot = UINT32_MAX;
+        std::vector<IndexEntry> index_;
+        size_t index_mask_ = 0;
+
+        static uint32_t hashName(std::string_view name);
+        // позиция имени в index_ или SIZE_MAX
+        size_t findPosition(std::string_view name, uint32_t hash) const;
+        void growIndex(size_t count);
+        NpcHandle place(Npc* npc, uint32_t hash, bool pooled);
+        void destroyObject(uint32_t slot);
+
+        std::vector<uint32_t> free_slots_;
+        size_t size_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Тип NPC, определяется один раз при создании.
+// Значения служат индексами таблицы убийств и массивов хранилища.
+enum class NpcType : uint8_t {
+    Dragon = 0,
+    Elf = 1,
+    Druid = 2,
+    Unknown = 3
+};
+
+constexpr size_t kNpcTypeCount = 3;
+
+// kKillMatrix[атакующий][защищающийся]: кто кого может убить
+constexpr std::array<std::array<bool, kNpcTypeCount>, kNpcTypeCount> kKillMatrix = {{
+    //            Dragon Elf    Druid
+    /* Dragon */ {{false, true,  false}},  // дракон нападает на эльфов
+    /* Elf    */ {{false, false, true }},  // эльф нападает на друидов
+    /* Druid  */ {{true,  false, false}},  // друид нападает на драконов
+}};
+
+constexpr bool canKill(NpcType attacker, NpcType defender) {
+    const auto a = static_cast<size_t>(attacker);
+    const auto d = static_cast<size_t>(defender);
+    return a < kNpcTypeCount && d < kNpcTypeCount && kKillMatrix[a][d];
+}
+
+// Unknown для незнакомой строки
+NpcType npcTypeFromString(std::string_view type);
+const std::string& npcTypeName(NpcType type);
+// символ на карте
+char npcTypeSymbol(NpcType type);
\ No newline at end of file
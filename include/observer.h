@@ -1,9 +1,35 @@
 #pragma once
 #include <string>
+#include <vector>
+#include "battle_event.h"
 
 class Observer {
     public:
     virtual ~Observer() = default;
 
     virtual void notify(const std::string& event) = 0;
+
+    // Пачка событий от диспетчера; по умолчанию - по одному
+    virtual void notifyBatch(const std::vector<std::string>& events) {
+        for (const auto& event : events) {
+            notify(event);
+        }
+    }
+
+    // Итог боя; по умолчанию превращается в текст и уходит в notify
+    virtual void onBattle(const BattleEvent& event, const BattleEventContext& context) {
+        notify(formatBattleEvent(event, context));
+    }
+
+    virtual void onBattleBatch(const std::vector<BattleEvent>& events, const BattleEventContext& context) {
+        for (const auto& event : events) {
+            onBattle(event, context);
+        }
+    }
+
+    // Вызывается диспетчером каждый flush interval, даже без новых событий
+    virtual void poll() {}
+
+    // Вызывается при остановке диспетчера: всё накопленное должно быть записано
+    virtual void flush() {}
 };
\ No newline at end of file
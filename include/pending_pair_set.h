@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Множество пар NPC, у которых есть неразрешённый бой.
+// Открытая адресация с линейным пробированием по 64-битному ключу пары.
+//
+// Добавляет ключи один поток (поток движения), удаляют - потоки боёв.
+// Удаление оставляет "надгробие", чтобы не рвать цепочки пробирования;
+// надгробия в конце цепочки вычищает добавляющий поток. Когда надгробий
+// накапливается много, он же уплотняет таблицу: переносит ключи ближе к
+// домашним слотам и освобождает надгробия, через которые не идёт ни один путь.
+// Удаляющие потоки, разминувшиеся с переносом, повторяют поиск по счётчику moves_.
+class PendingPairSet {
+    public:
+        enum class InsertResult { Inserted, Duplicate, Full };
+
+        explicit PendingPairSet(size_t capacity);
+
+        // ключ пары не зависит от порядка NPC
+        static uint64_t pairKey(uint32_t first, uint32_t second);
+
+        // Full - свободных слотов нет, ключ не сохранён
+        InsertResult insert(uint64_t key);
+        void erase(uint64_t key);
+        bool contains(uint64_t key) const;
+
+        size_t size() const { return size_.load(std::memory_order_relaxed); }
+        size_t capacity() const { return capacity_; }
+        size_t tombstones() const { return tombstones_.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr uint64_t kEmpty = 0;
+        static constexpr uint64_t kTombstone = 1;
+
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+        std::atomic<size_t> size_;
+        std::atomic<size_t> tombstones_;
+        // нечётное значение - идёт перенос ключа
+        std::atomic<uint64_t> moves_;
+        // порог надгробий для следующего уплотнения (только добавляющий поток)
+        size_t next_compaction_;
+
+        // хранимое значение смещено, чтобы не совпасть с пустым слотом и надгробием
+        static uint64_t encode(uint64_t key) { return key + 2; }
+        size_t home(uint64_t key) const;
+        void compact();
+        // были ли переносы с момента чтения счётчика moves_
+        bool movedSince(uint64_t moves) const;
+};
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+// Счётный генератор случайных чисел (SplitMix64 по номеру).
+// Поток задаётся главным зерном, видом и идентификаторами (NPC, пара, тик);
+// n-е число потока - перемешанный ключ плюс n, так что результат не зависит
+// от того, какой поток и в каком порядке его запрашивает.
+class RandomStream {
+    public:
+        enum class Kind : uint64_t {
+            Spawn = 1,
+            Movement = 2,
+            Fight = 3
+        };
+
+        RandomStream(uint64_t seed, Kind kind, uint64_t id, uint64_t subId = 0)
+            : key_(mix(mix(mix(seed + static_cast<uint64_t>(kind) * kGamma) ^ id) ^ subId)),
+              counter_(0) {}
+
+        uint64_t next() {
+            counter_++;
+            return mix(key_ + counter_ * kGamma);
+        }
+
+        // равномерно в [low, high]
+        int uniform(int low, int high) {
+            const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(high) - low) + 1;
+            return low + static_cast<int>(((next() >> 32) * range) >> 32);
+        }
+
+        static uint64_t mix(uint64_t x) {
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+
+    private:
+        static constexpr uint64_t kGamma = 0x9E3779B97F4A7C15ull;
+
+        uint64_t key_;
+        uint64_t counter_;
+};
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "npc_type.h"
+
+// Проверка одного NPC против блока кандидатов: кто в радиусе и враждебен.
+// Кандидаты лежат структурой массивов (x, y, тип), расстояние сравнивается
+// в квадратах, без sqrt. Результат - битовая маска: бит j установлен, если
+// кандидат j подходит. В блоке не больше kRangeBlockSize кандидатов.
+//
+// Реализация выбирается при первом вызове по возможностям процессора:
+// AVX2 (8 кандидатов за шаг), SSE4.1 (4) или скалярная.
+
+constexpr size_t kRangeBlockSize = 64;
+
+// Векторные пути считают квадраты в 32 битах: они используются при радиусе
+// меньше kVectorRangeLimit и разности координат, помещающейся в int32
+// (координаты арены лежат в [0, kMaxCoordinate]). Иначе - скалярный путь.
+constexpr int64_t kVectorRangeLimit = 32767;
+
+enum class RangeKernel {
+    Scalar,
+    SSE41,
+    AVX2
+};
+
+struct RangeBlock {
+    const int32_t* x;
+    const int32_t* y;
+    const uint8_t* types;
+    size_t count;
+};
+
+struct RangeQuery {
+    int32_t x;
+    int32_t y;
+    // подходит кандидат с dx*dx + dy*dy <= range_sq; при range_sq < 0 - никто
+    int64_t range_sq;
+    // бит t установлен, если NPC типа t - противник
+    uint8_t hostile;
+};
+
+uint64_t rangeMask(const RangeQuery& query, const RangeBlock& block);
+// конкретная реализация; неподдерживаемая процессором заменяется скалярной
+uint64_t rangeMask(RangeKernel kernel, const RangeQuery& query, const RangeBlock& block);
+
+RangeKernel activeRangeKernel();
+bool rangeKernelSupported(RangeKernel kernel);
+const char* rangeKernelName(RangeKernel kernel);
+
+// наибольший целый квадрат d с sqrt(d) <= range, как при сравнении через sqrt;
+// -1 для отрицательного радиуса и NaN
+int64_t squaredRange(double range);
+
+// типы, с которыми NPC типа type может сражаться (в любую сторону)
+constexpr uint8_t hostileTypes(NpcType type) {
+    uint8_t mask = 0;
+    for (size_t other = 0; other < kNpcTypeCount; ++other) {
+        if (canKill(type, static_cast<NpcType>(other)) || canKill(static_cast<NpcType>(other), type)) {
+            mask |= static_cast<uint8_t>(1u << other);
+        }
+    }
+    return mask;
+}
+
+// Вызывает callback(k) для каждого подходящего кандидата с индексом k из
+// [first, last) массивов x, y, types. Короткие хвосты проверяются на месте:
+// вызов векторной реализации для пары кандидатов дороже самой проверки
+template <typename Callback>
+void forEachInRange(const RangeQuery& query, const int32_t* x, const int32_t* y, const uint8_t* types,
+                    size_t first, size_t last, Callback&& callback) {
+    constexpr size_t kInlineLimit = 4;
+    while (first < last) {
+        const size_t count = last - first < kRangeBlockSize ? last - first : kRangeBlockSize;
+        if (count <= kInlineLimit) {
+            for (size_t k = first; k < first + count; ++k) {
+                if (!(query.hostile >> types[k] & 1u)) continue;
+                const int64_t dx = static_cast<int64_t>(x[k]) - query.x;
+                const int64_t dy = static_cast<int64_t>(y[k]) - query.y;
+                if (dx * dx + dy * dy <= query.range_sq) callback(k);
+            }
+        } else {
+            uint64_t mask = rangeMask(query, {x + first, y + first, types + first, count});
+            while (mask != 0) {
+                callback(first + static_cast<size_t>(__builtin_ctzll(mask)));
+                mask &= mask - 1;
+            }
+        }
+        first += count;
+    }
+}
\ No newline at end of file
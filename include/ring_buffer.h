@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Ограниченный lock-free кольцевой буфер для многих производителей и
+// потребителей (схема Вьюкова). Каждая ячейка хранит номер последовательности,
+// по которому производитель и потребитель понимают, свободна ли она.
+// Позиции записи и чтения и каждая ячейка занимают свою кэш-линию, чтобы
+// потоки, работающие с соседними ячейками, не мешали друг другу.
+template <typename T>
+class MpmcRingBuffer {
+    public:
+        static constexpr size_t kCacheLine = 64;
+
+        explicit MpmcRingBuffer(size_t capacity)
+            : capacity_(roundUp(capacity)), mask_(capacity_ - 1),
+              cells_(new Cell[capacity_]), push_pos_(0), pop_pos_(0) {
+            for (size_t i = 0; i < capacity_; ++i) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+        MpmcRingBuffer& operator=(const MpmcRingBuffer&) = delete;
+
+        // rvalue забирается только при успешной записи: при полном буфере
+        // элемент остаётся у вызывающего и его можно передать повторно
+        template <typename U>
+        bool tryPush(U&& item) {
+            size_t pos = push_pos_.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = cells_[pos & mask_];
+                size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                if (diff == 0) {
+                    if (push_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.data = std::forward<U>(item);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = push_pos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool tryPop(T& out) {
+            size_t pos = pop_pos_.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = cells_[pos & mask_];
+                size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+                if (diff == 0) {
+                    if (pop_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        out = std::move(cell.data);
+                        cell.sequence.store(pos + capacity_, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = pop_pos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        size_t capacity() const { return capacity_; }
+
+        // приблизительный размер: точен, только когда нет одновременных операций
+        size_t size() const {
+            size_t pushed = push_pos_.load(std::memory_order_acquire);
+            size_t popped = pop_pos_.load(std::memory_order_acquire);
+            return pushed > popped ? pushed - popped : 0;
+        }
+
+    private:
+        struct alignas(kCacheLine) Cell {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        static size_t roundUp(size_t value) {
+            size_t result = 2;
+            while (result < value) result <<= 1;
+            return result;
+        }
+
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+
+        alignas(kCacheLine) std::atomic<size_t> push_pos_;
+        alignas(kCacheLine) std::atomic<size_t> pop_pos_;
+};
\ No newline at end of file
@@ -0,0 +1,158 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Публикация неизменяемых снимков через атомарный указатель (в духе RCU).
+// Читатель объявляет снимок в своей hazard-ячейке и читает его без блокировок;
+// писатель подменяет указатель и удаляет старые снимки, только когда ни одна
+// ячейка на них не указывает.
+template <typename T>
+class SnapshotPublisher {
+    private:
+        struct Slot;
+
+    public:
+        static constexpr size_t kMaxReaders = 64;
+
+        class Guard {
+            public:
+                Guard() = default;
+                Guard(Guard&& other) noexcept : slot_(other.slot_), value_(other.value_) {
+                    other.slot_ = nullptr;
+                    other.value_ = nullptr;
+                }
+                Guard& operator=(Guard&& other) noexcept {
+                    if (this != &other) {
+                        release();
+                        slot_ = other.slot_;
+                        value_ = other.value_;
+                        other.slot_ = nullptr;
+                        other.value_ = nullptr;
+                    }
+                    return *this;
+                }
+                Guard(const Guard&) = delete;
+                Guard& operator=(const Guard&) = delete;
+                ~Guard() { release(); }
+
+                const T* get() const { return value_; }
+                const T* operator->() const { return value_; }
+                const T& operator*() const { return *value_; }
+                explicit operator bool() const { return value_ != nullptr; }
+
+            private:
+                friend class SnapshotPublisher;
+                Slot* slot_ = nullptr;
+                const T* value_ = nullptr;
+
+                Guard(Slot* slot, const T* value) : slot_(slot), value_(value) {}
+                void release() {
+                    if (!slot_) return;
+                    slot_->hazard.store(nullptr, std::memory_order_release);
+                    slot_->busy.store(false, std::memory_order_release);
+                    slot_ = nullptr;
+                }
+        };
+
+        SnapshotPublisher() : current_(nullptr) {
+            for (auto& slot : slots_) {
+                slot.busy.store(false, std::memory_order_relaxed);
+                slot.hazard.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        ~SnapshotPublisher() {
+            delete current_.load();
+            for (T* old : retired_) {
+                delete old;
+            }
+        }
+
+        SnapshotPublisher(const SnapshotPublisher&) = delete;
+        SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+        // текущий снимок (пустой Guard, если ещё ничего не опубликовано)
+        Guard acquire() const {
+            Slot* slot = claimSlot();
+            const T* value;
+            do {
+                value = current_.load(std::memory_order_seq_cst);
+                slot->hazard.store(value, std::memory_order_seq_cst);
+                // снимок могли подменить до того, как ячейка стала видна писателю
+            } while (current_.load(std::memory_order_seq_cst) != value);
+            return Guard(slot, value);
+        }
+
+        void publish(std::unique_ptr<T> next) {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            T* old = current_.exchange(next.release(), std::memory_order_seq_cst);
+            if (old) retired_.push_back(old);
+            reclaim();
+        }
+
+        // снимков, ещё удерживаемых читателями
+        size_t getRetiredCount() const {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            return retired_.size();
+        }
+
+    private:
+        struct alignas(64) Slot {
+            std::atomic<bool> busy;
+            std::atomic<const T*> hazard;
+        };
+
+        mutable std::array<Slot, kMaxReaders> slots_;
+        std::atomic<T*> current_;
+        mutable std::mutex writer_mutex_;
+        std::vector<T*> retired_;
+        std::vector<const T*> hazards_;
+
+        Slot* claimSlot() const {
+            // разные потоки начинают поиск с разных ячеек
+            size_t index = std::hash<std::thread::id>{}(std::this_thread::get_id()) % kMaxReaders;
+            for (;;) {
+                for (size_t i = 0; i < kMaxReaders; ++i) {
+                    Slot& slot = slots_[(index + i) % kMaxReaders];
+                    bool expected = false;
+                    if (!slot.busy.load(std::memory_order_relaxed) &&
+                        slot.busy.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                        return &slot;
+                    }
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        void reclaim() {
+            hazards_.clear();
+            for (const auto& slot : slots_) {
+                if (const T* value = slot.hazard.load(std::memory_order_seq_cst)) {
+                    hazards_.push_back(value);
+                }
+            }
+
+            size_t kept = 0;
+            for (T* old : retired_) {
+                bool inUse = false;
+                for (const T* hazard : hazards_) {
+                    if (hazard == old) {
+                        inUse = true;
+                        break;
+                    }
+                }
+                if (inUse) {
+                    retired_[kept++] = old;
+                } else {
+                    delete old;
+                }
+            }
+            retired_.resize(kept);
+        }
+};
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Разреженная сетка для поиска пар NPC, находящихся рядом.
+// Размер ячейки не меньше максимального радиуса проверки, поэтому
+// кандидаты в пару ищутся только в своей и соседних ячейках.
+// Память выделяется только под занятые ячейки (хеш-таблица по координатам
+// ячейки), так что размер мира не важен - важно только число NPC.
+class SpatialGrid {
+    public:
+        struct Entry {
+            int x;
+            int y;
+            uint32_t id;
+        };
+
+        // Перестроение сетки по позициям (сортировка подсчётом по занятым ячейкам)
+        void rebuild(int cellSize, const std::vector<Entry>& entries);
+
+        // Вызывает callback(a, b) для каждой пары из соседних ячеек ровно один раз
+        template <typename Callback>
+        void forEachCandidatePair(Callback&& callback) const {
+            forEachCandidatePair(0, cells_.size(), callback);
+        }
+        // То же для пар, первая ячейка которых из [firstCell, lastCell):
+        // непересекающиеся диапазоны можно обходить из разных потоков
+        template <typename Callback>
+        void forEachCandidatePair(size_t firstCell, size_t lastCell, Callback&& callback) const;
+        // Те же пары блоками для пакетной проверки (range_kernel.h):
+        // callback(k, first, last) - NPC с позицией k в порядке ячеек и кандидаты
+        // с позициями [first, last). Координаты по позициям - getSortedX/Y
+        template <typename Callback>
+        void forEachCandidateBlock(size_t firstCell, size_t lastCell, Callback&& callback) const;
+
+        // NPC в порядке ячеек и их координаты отдельными массивами
+        const std::vector<Entry>& getSorted() const { return sorted_; }
+        const int32_t* getSortedX() const { return sorted_x_.data(); }
+        const int32_t* getSortedY() const { return sorted_y_.data(); }
+
+        int getCellSize() const { return cell_size_; }
+        // число занятых ячеек
+        size_t getCellCount() const { return cells_.size(); }
+        size_t size() const { return sorted_.size(); }
+
+    private:
+        static constexpr uint32_t kNoCell = UINT32_MAX;
+
+        struct Cell {
+            int cx;
+            int cy;
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        int cell_size_ = 1;
+        // занятые ячейки в порядке первого появления
+        std::vector<Cell> cells_;
+        // открытая адресация: индекс в cells_ или kNoCell
+        std::vector<uint32_t> table_;
+        size_t mask_ = 0;
+        std::vector<uint32_t> entry_cells_;
+        std::vector<Entry> sorted_;
+        std::vector<int32_t> sorted_x_;
+        std::vector<int32_t> sorted_y_;
+
+        int cellCoord(int value) const;
+        uint32_t findOrInsert(int cx, int cy);
+        const Cell* find(int cx, int cy) const;
+
+        static size_t hashCell(int cx, int cy) {
+            uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(cy)) << 32) |
+                           static_cast<uint32_t>(cx);
+            return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+        }
+};
+
+inline const SpatialGrid::Cell* SpatialGrid::find(int cx, int cy) const {
+    for (size_t pos = hashCell(cx, cy) & mask_;; pos = (pos + 1) & mask_) {
+        uint32_t index = table_[pos];
+        if (index == kNoCell) return nullptr;
+        const Cell& cell = cells_[index];
+        if (cell.cx == cx && cell.cy == cy) return &cell;
+    }
+}
+
+template <typename Callback>
+void SpatialGrid::forEachCandidatePair(size_t firstCell, size_t lastCell, Callback&& callback) const {
+    // половина окрестности: каждая пара соседних ячеек просматривается один раз
+    static const int kNeighbours[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+    for (size_t index = firstCell; index < lastCell; ++index) {
+        const Cell& cell = cells_[index];
+        for (uint32_t i = cell.begin; i < cell.end; ++i) {
+            for (uint32_t j = i + 1; j < cell.end; ++j) {
+                callback(sorted_[i], sorted_[j]);
+            }
+        }
+
+        for (const auto& offset : kNeighbours) {
+            const Cell* other = find(cell.cx + offset[0], cell.cy + offset[1]);
+            if (!other) continue;
+
+            for (uint32_t i = cell.begin; i < cell.end; ++i) {
+                for (uint32_t j = other->begin; j < other->end; ++j) {
+                    callback(sorted_[i], sorted_[j]);
+                }
+            }
+        }
+    }
+}
+
+template <typename Callback>
+void SpatialGrid::forEachCandidateBlock(size_t firstCell, size_t lastCell, Callback&& callback) const {
+    // порядок пар тот же, что у forEachCandidatePair
+    static const int kNeighbours[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+    for (size_t index = firstCell; index < lastCell; ++index) {
+        const Cell& cell = cells_[index];
+        for (uint32_t i = cell.begin; i + 1 < cell.end; ++i) {
+            callback(i, i + 1, cell.end);
+        }
+
+        for (const auto& offset : kNeighbours) {
+            const Cell* other = find(cell.cx + offset[0], cell.cy + offset[1]);
+            if (!other) continue;
+
+            for (uint32_t i = cell.begin; i < cell.end; ++i) {
+                callback(i, other->begin, other->end);
+            }
+        }
+    }
+}
\ No newline at end of file
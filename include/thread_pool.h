@@ -0,0 +1,42 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков фиксированного размера с общей очередью задач.
+class ThreadPool {
+    public:
+        // threads == 0 - по числу аппаратных потоков
+        explicit ThreadPool(size_t threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(std::function<void()> task);
+        // ждёт завершения всех поставленных задач
+        void wait();
+
+        // вызывает body(i, worker) для i из [0, count) на всех потоках пула и ждёт.
+        // worker из [0, size()) - номер исполнителя для его собственных данных;
+        // индексы раздаются по одному, так что неравные по длительности задачи
+        // не оставляют потоки без работы
+        void parallelFor(size_t count, const std::function<void(size_t, size_t)>& body);
+
+        size_t size() const { return workers_.size(); }
+
+    private:
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable task_cv_;
+        std::condition_variable idle_cv_;
+        size_t active_ = 0;
+        bool stopping_ = false;
+
+        void workerThreadFunc();
+};
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Задержки одной стадии конвейера
+struct StageLatency {
+    uint64_t count = 0;
+    std::chrono::microseconds last{0};
+    std::chrono::microseconds max{0};
+    std::chrono::microseconds total{0};
+
+    void add(std::chrono::microseconds duration);
+    std::chrono::microseconds mean() const;
+};
+
+struct PipelineStats {
+    // тиков, прошедших все стадии
+    uint64_t ticks = 0;
+    StageLatency move;
+    StageLatency combat;
+    StageLatency publish;
+    // от начала движения до конца публикации тика
+    StageLatency end_to_end;
+    // тиков, движение которых шло одновременно с боями предыдущего
+    uint64_t overlapped = 0;
+};
+
+// Конвейер тиков игры. Тик проходит стадии по порядку:
+//   move    - движение и поиск боёв,
+//   combat  - разрешение боёв, найденных на этом тике,
+//   publish - снимок мира для отрисовки.
+// Движение и бои идут в разных потоках: движение тика N+1 выполняется
+// одновременно с боями и публикацией тика N, но не раньше, чем закончены бои
+// тика N-1. Поэтому в работе не больше двух тиков, и стадиям хватает двух
+// буферов (номер тика & 1), которые никогда не используются одновременно.
+// Бои отстают от обнаружения не больше чем на один тик.
+//
+// Движение начинается не чаще раза в interval; если тик не успел, следующий
+// стартует сразу, пропущенные не догоняются.
+class TickPipeline {
+    public:
+        struct Stages {
+            // аргумент - номер тика конвейера, начиная с 1
+            std::function<void(uint64_t)> move;
+            std::function<void(uint64_t)> combat;
+            std::function<void(uint64_t)> publish;
+        };
+
+        TickPipeline(Stages stages, std::chrono::milliseconds interval);
+        ~TickPipeline();
+
+        TickPipeline(const TickPipeline&) = delete;
+        TickPipeline& operator=(const TickPipeline&) = delete;
+
+        void start();
+        // новых тиков не начинает; тик, прошедший движение, доводит до публикации
+        void stop();
+
+        PipelineStats getStats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        Stages stages_;
+        std::chrono::milliseconds interval_;
+
+        std::thread move_thread_;
+        std::thread combat_thread_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        bool running_ = false;
+        // поток движения ещё может выдать тик
+        bool moving_ = false;
+        // последний тик, прошедший движение, и последний завершённый
+        uint64_t moved_ = 0;
+        uint64_t completed_ = 0;
+        Clock::time_point started_[2];
+        PipelineStats stats_;
+
+        void moveThreadFunc();
+        void combatThreadFunc();
+};
\ No newline at end of file
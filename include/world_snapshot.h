@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "npc_store.h"
+
+// Неизменяемое состояние мира на момент публикации.
+// Читается без блокировки арены; имена общие для снимков, пока
+// состав NPC не меняется.
+struct WorldSnapshot {
+    struct Entry {
+        NpcHandle handle;
+        int x;
+        int y;
+        NpcType type;
+        bool alive;
+        // действителен, пока NPC не удалён из арены
+        Npc* object;
+    };
+
+    uint64_t tick = 0;
+    size_t alive = 0;
+    // все NPC в порядке слотов хранилища
+    std::vector<Entry> npcs;
+    // имена по индексу слота
+    std::shared_ptr<const std::vector<std::string>> names;
+
+    const std::string& nameOf(const Entry& entry) const { return (*names)[entry.handle.index]; }
+};
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "include/file_observer.h"
 #include <iostream>
 #include <memory>
+#include <thread>
+#include <algorithm>
 
 int main() {
     try {
@@ -28,16 +30,19 @@ int main() {
         std::cout << "  Druid:  Move=10, Kill=10" << std::endl;
         std::cout << std::endl;
 
+        const int battleWorkers = std::max(1u, std::thread::hardware_concurrency());
+
         std::cout << "Starting game for 30 seconds..." << std::endl;
         std::cout << "Threads:" << std::endl;
-        std::cout << "  1. NPC movement thread (collision detection)" << std::endl;
-        std::cout << "  2. Battle system thread (dice rolls)" << std::endl;
+        std::cout << "  1. Tick pipeline: movement and collision detection overlap the previous tick's battles" << std::endl;
+        std::cout << "  2. Battle worker threads x" << battleWorkers << " (dice rolls)" << std::endl;
         std::cout << "  3. Map output thread (every second)" << std::endl;
         std::cout << std::endl;
         std::cout << "Map legend: D=Dragon, E=Elf, R=Druid, .=empty" << std::endl;
         std::cout << "==========================================================\n" << std::endl;
 
-        arena.startGame(30);
+        arena.setMetricsOutput("metrics.prom");
+        arena.startGame(30, battleWorkers);
 
         std::cout << "\nChecking if battle log file exists..." << std::endl;
         std::ifstream test_file("battle_log.txt");
@@ -54,6 +59,7 @@ int main() {
         arena.printSurvivors();
 
         std::cout << "Logs saved to file 'battle_log.txt'" << std::endl;
+        std::cout << "Metrics saved to file 'metrics.prom'" << std::endl;
         std::cout << "=== Program completed successfully ===" << std::endl;
 
     } catch (const std::exception& e) {
@@ -5,25 +5,71 @@
 #include <string>
 #include <algorithm>
 #include <random>
+#include "../include/random_stream.h"
 #include <chrono>
-#include <sstream>
-#include <iomanip>
+#include <cmath>
+#include <charconv>
+#include <climits>
 #include "../include/arena.h"
-#include "../include/factory.h"
-#include "../include/combat_visitor.h"
+#include "../include/binary_snapshot.h"
+#include "../include/checkpointer.h"
+#include "../include/range_kernel.h"
+
+namespace {
+
+// броски боя берутся из потока, заданного парой и тиком, а не потоком ОС
+uint8_t rollDice(RandomStream& dice) {
+    return static_cast<uint8_t>(dice.uniform(1, 6));
+}
+
+uint64_t randomSeed() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+// сколько задач поток разрешает под одной разделяемой блокировкой
+const size_t kBattleBatch = 64;
+// с какого числа NPC startBattle ищет пары на пуле потоков
+const size_t kParallelBattleThreshold = 4096;
+// с какого числа слотов движение идёт на пуле потоков и по сколько слотов в задаче
+const uint32_t kParallelMovementThreshold = 4096;
+const uint32_t kMovementChunk = 1024;
 
-int rollDice() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<int> dice(1, 6);
-    return dice(gen);
 }
 
 Arena::Arena(int width, int height) 
-    : width_(width), height_(height), running_(false) {
-    if (width > MAX_WIDTH || height > MAX_HEIGHT) {
+    : width_(width), height_(height), event_context_(*this), running_(false), tick_count_(0),
+      seed_(randomSeed()), renderer_(std::min(width, MAX_WIDTH), std::min(height, MAX_HEIGHT)), map_mode_(MapRenderer::Mode::Full),
+      snapshot_stale_(true), membership_version_(0), snapshot_names_version_(UINT64_MAX),
+      metrics_(metrics_registry_) {
+    if (width < 0 || height < 0 || width > kMaxCoordinate || height > kMaxCoordinate) {
         throw std::out_of_range("Arena size exceeds maximum limits.");
     }
+    events_.setBattleContext(&event_context_);
+    setBattleWorkers(1);
+}
+
+Arena::Metrics::Metrics(MetricsRegistry& registry)
+    : move(registry.histogram("lab7_move_seconds", "Movement of all NPCs in one sampled tick", 1e-9)),
+      pair_scan(registry.histogram("lab7_pair_scan_seconds", "Battle pair search in one sampled tick", 1e-9)),
+      battle_wait(registry.histogram("lab7_battle_wait_seconds",
+                                     "Combat stage wait for battle workers to resolve a sampled tick", 1e-9)),
+      battle_queue_push(registry.histogram("lab7_battle_queue_push_seconds",
+                                           "Pushing one sampled tick of battles, including backpressure", 1e-9)),
+      notify(registry.histogram("lab7_notify_seconds", "Arena::notifyObservers per sampled battle event", 1e-9)),
+      print_lock(registry.histogram("lab7_print_lock_seconds", "printMap render lock hold time", 1e-9)),
+      npcs_lock_wait(registry.histogram("lab7_npcs_lock_wait_seconds",
+                                        "Wait to acquire npcs_mutex_ held by another thread", 1e-9)),
+      queue_depth(registry.histogram("lab7_battle_queue_depth", "Pending battles after a sampled tick is pushed")),
+      kills_per_tick(registry.histogram("lab7_kills_per_tick", "NPCs killed while resolving one sampled tick")),
+      ticks(registry.counter("lab7_ticks_total", "Simulation ticks")),
+      battles(registry.counter("lab7_battles_total", "Battle tasks resolved")),
+      kills(registry.counter("lab7_kills_total", "NPCs killed")),
+      alive(registry.gauge("lab7_alive_npcs", "Alive NPCs in the last published snapshot")) {}
+
+std::string_view Arena::EventContext::nameOf(NpcHandle npc) const {
+    if (!arena_.npcs_.valid(npc)) return {};
+    return arena_.npcs_.getName(npc.index);
 }
 
 Arena::~Arena() {
@@ -32,168 +78,387 @@ Arena::~Arena() {
 
 void Arena::addNpc(std::unique_ptr<Npc> npc) {
     std::unique_lock<std::shared_mutex> lock(npcs_mutex_);
-    const std::string name = npc->getName();
 
     if (npc->getX() < 0 || npc->getX() > width_ ||
         npc->getY() < 0 || npc->getY() > height_) {
         throw std::out_of_range("NPC position is out of arena bounds.");
     }
 
-    if (npcs_.find(name) != npcs_.end()) {
-        throw std::invalid_argument("NPC with this name already exists.");
-    }
-    npcs_[name] = std::move(npc);
+    npcs_.insert(std::move(npc));
+    membership_version_++;
+    snapshot_stale_ = true;
 }
 
 void Arena::createAndAddNpc(const std::string& type, 
                             const std::string& name, 
                             int x, int y) {
-    auto npc = NpcFactory::createNpc(type, name, x, y);
-    addNpc(std::move(npc));
+    const NpcType id = npcTypeFromString(type);
+    if (id == NpcType::Unknown) {
+        throw std::invalid_argument("Unknown NPC type: " + type);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(npcs_mutex_);
+    if (!isValidPosition(x, y)) {
+        throw std::out_of_range("NPC position is out of arena bounds.");
+    }
+    // объект создаётся сразу в пуле хранилища
+    if (!npcs_.emplace(id, name, x, y).isValid()) {
+        throw std::invalid_argument("NPC with this name already exists.");
+    }
+    membership_version_++;
+    snapshot_stale_ = true;
+}
+
+SnapshotPublisher<WorldSnapshot>::Guard Arena::snapshot() const {
+    if (snapshot_stale_) {
+        std::shared_lock<std::shared_mutex> lock(npcs_mutex_);
+        publishSnapshot(true);
+    }
+    return snapshots_.acquire();
+}
+
+void Arena::publishSnapshot(bool onlyIfStale, const TickBuffer* frame) const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    // несколько читателей, заметивших устаревший снимок, пересоберут его один раз
+    if (onlyIfStale && !snapshot_stale_) return;
+    snapshot_stale_ = false;
+
+    // таблица имён пересобирается только при изменении состава NPC
+    const uint64_t version = membership_version_;
+    if (!snapshot_names_ || snapshot_names_version_ != version) {
+        auto names = std::make_shared<std::vector<std::string>>(npcs_.slotCount());
+        for (uint32_t i = 0; i < npcs_.slotCount(); ++i) {
+            if (npcs_.occupied(i)) (*names)[i] = npcs_.getName(i);
+        }
+        snapshot_names_ = std::move(names);
+        snapshot_names_version_ = version;
+    }
+
+    // позиции кадра годятся, только если состав NPC с тех пор не менялся
+    if (frame && (frame->membership != version || frame->states.size() != npcs_.slotCount())) {
+        frame = nullptr;
+    }
+
+    auto world = std::make_unique<WorldSnapshot>();
+    world->tick = frame ? frame->tick : tick_count_.load(std::memory_order_relaxed);
+    world->names = snapshot_names_;
+    world->npcs.reserve(npcs_.size());
+    for (uint32_t i = 0; i < npcs_.slotCount(); ++i) {
+        if (!npcs_.occupied(i)) continue;
+        NpcState::Value state = npcs_.loadState(i);
+        if (frame) {
+            state.x = frame->states[i].x;
+            state.y = frame->states[i].y;
+        }
+        world->npcs.push_back({npcs_.handleAt(i), state.x, state.y, npcs_.getTypeId(i),
+                               state.alive, npcs_.getObject(i)});
+        if (state.alive) world->alive++;
+    }
+    LAB7_METRIC_SET(metrics_.alive, static_cast<int64_t>(world->alive));
+    snapshots_.publish(std::move(world));
 }
 
 void Arena::printAllNpcs() const {
     std::shared_lock<std::shared_mutex> lock(npcs_mutex_);
-    for (const auto& pair : npcs_) {
-        std::cout << *(pair.second) << std::endl;
+    for (uint32_t i = 0; i < npcs_.slotCount(); ++i) {
+        if (npcs_.occupied(i)) {
+            std::cout << *npcs_.getObject(i) << std::endl;
+        }
     }
 }
 
 size_t Arena::getNpcCount() const {
-    std::shared_lock<std::shared_mutex> lock(npcs_mutex_);
-    return npcs_.size();
+    return snapshot()->npcs.size();
 }
 
 size_t Arena::getAliveCount() const {
+    return snapshot()->alive;
+}
+
+void Arena::saveToFile(const std::string& filename, SaveFormat format) const {
     std::shared_lock<std::shared_mutex> lock(npcs_mutex_);
-    size_t count = 0;
-    for (const auto& [name, npc] : npcs_) {
-        if (npc->isAlive()) {
-            count++;
+
+    if (format == SaveFormat::Binary) {
+        BinarySnapshotWriter writer(npcs_.size());
+        for (uint32_t i = 0; i < npcs_.slotCount(); ++i) {
+            if (!npcs_.occupied(i)) continue;
+            NpcState::Value state = npcs_.loadState(i);
+            writer.add(npcs_.getTypeId(i), npcs_.getName(i), state.x, state.y, state.alive);
         }
+        lock.unlock();
+        writer.write(filename);
+        return;
     }
-    return count;
-}
 
-void Arena::saveToFile(const std::string& filename) const {
-    std::shared_lock<std::shared_mutex> lock(npcs_mutex_);
     std::ofstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open file for writing: " + filename);
     }
 
-    for (const auto& [name, npc] : npcs_) {
-        file << npc->getType() << " "
-             << npc->getName() << " "
-             << npc->getX() << " "
-             << npc->getY() << std::endl;
+    // строки собираются в буфер и уходят в файл крупными кусками
+    std::string buffer;
+    buffer.reserve(1 << 16);
+    char number[16];
+    for (uint32_t i = 0; i < npcs_.slotCount(); ++i) {
+        if (!npcs_.occupied(i)) continue;
+        NpcState::Value state = npcs_.loadState(i);
+        if (!state.alive) continue;
+        buffer += npcTypeName(npcs_.getTypeId(i));
+        buffer += ' ';
+        buffer += npcs_.getName(i);
+        buffer += ' ';
+        buffer.append(number, std::to_chars(number, number + sizeof(number), state.x).ptr);
+        buffer += ' ';
+        buffer.append(number, std::to_chars(number, number + sizeof(number), state.y).ptr);
+        buffer += '\n';
+        if (buffer.size() >= (1 << 16) - 256) {
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
     }
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 }
 
-void Arena::loadFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file for reading: " + filename);
+LoadReport Arena::loadFromFile(const std::string& filename) {
+    MappedFile file(filename);
+    LoadReport report;
+    report.bytes = file.size();
+
+    std::vector<NpcRecord> records;
+    if (isBinarySnapshot(file.view())) {
+        report.lines = parseBinarySnapshot(file.view(), records, report.errors);
+    } else {
+        report.lines = parseNpcRecords(file.view(), records, report.errors);
     }
+    insertRecords(records, report);
+    return report;
+}
 
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        auto npc = NpcFactory::createFromString(line);
-        addNpc(std::move(npc));
+LoadReport Arena::restoreCheckpoint(const std::string& directory) {
+    if (running_) {
+        throw std::runtime_error("Game is already running");
+    }
+    CheckpointData data = readCheckpoint(directory);
+
+    LoadReport report;
+    report.bytes = data.bytes;
+    report.lines = data.records.size();
+    report.errors = std::move(data.errors);
+    seed_ = data.seed;
+    tick_count_ = data.tick;
+    insertRecords(data.records, report);
+    return report;
+}
+
+void Arena::insertRecords(const std::vector<NpcRecord>& records, LoadReport& report) {
+    const size_t parseErrors = report.errors.size();
+    {
+        std::unique_lock<std::shared_mutex> lock(npcs_mutex_);
+        npcs_.reserve(npcs_.size() + records.size());
+        for (const auto& record : records) {
+            // удаление имеет смысл только внутри каталога контрольных точек
+            if (record.removed) {
+                report.errors.push_back({record.line, "removed NPC record outside a checkpoint"});
+                continue;
+            }
+            if (!isValidPosition(record.x, record.y)) {
+                report.errors.push_back({record.line, "NPC position is out of arena bounds"});
+                continue;
+            }
+            NpcHandle handle = npcs_.emplace(record.type, record.name, record.x, record.y);
+            if (!handle.isValid()) {
+                report.errors.push_back({record.line, "NPC with this name already exists"});
+                continue;
+            }
+            if (!record.alive) npcs_.kill(handle.index);
+            report.loaded++;
+        }
+        membership_version_++;
+        snapshot_stale_ = true;
+    }
+
+    if (parseErrors != report.errors.size()) {
+        std::stable_sort(report.errors.begin(), report.errors.end(),
+                         [](const LoadError& a, const LoadError& b) { return a.line < b.line; });
     }
 }
 
 void Arena::clear() {
+    deliverPendingEvents();
     std::unique_lock<std::shared_mutex> lock(npcs_mutex_);
+    // задачи ссылаются на удаляемых NPC; стадия боёв считает их разрешёнными
+    const size_t dropped = battle_queue_->clear();
     npcs_.clear();
+    membership_version_++;
+    snapshot_stale_ = true;
+    lock.unlock();
+
+    if (dropped > 0) {
+        {
+            std::lock_guard<std::mutex> resolved_lock(resolved_mutex_);
+            battles_resolved_ += dropped;
+        }
+        resolved_cv_.notify_all();
+    }
 }
 
 void Arena::addObserver(std::shared_ptr<Observer> observer) {
-    std::lock_guard<std::mutex> lock(observers_mutex_);
-    observers_.push_back(observer);
+    events_.addObserver(std::move(observer));
 }
 
 void Arena::removeObserver(std::shared_ptr<Observer> observer) {
-    std::lock_guard<std::mutex> lock(observers_mutex_);
-    auto it = std::find(observers_.begin(), observers_.end(), observer);
-    if (it != observers_.end()) {
-        observers_.erase(it);
-    }
+    events_.removeObserver(observer);
+}
+
+void Arena::setEventFlushInterval(std::chrono::milliseconds interval) {
+    events_.setFlushInterval(interval);
+}
+
+void Arena::notifyObservers(const BattleEvent& event) {
+    LAB7_METRIC_TIME_SAMPLED(metrics_.notify, kMetricsEventPeriod);
+    events_.publish(event);
 }
 
-void Arena::notifyObservers(const std::string& event) {
-    std::lock_guard<std::mutex> lock(observers_mutex_);
-    for (auto& observer : observers_) {
-        observer->notify(event);
+void Arena::deliverPendingEvents() {
+    events_.waitUntilDelivered();
+}
+
+ThreadPool& Arena::workerPool() {
+    std::lock_guard<std::mutex> lock(worker_pool_mutex_);
+    if (!worker_pool_) worker_pool_ = std::make_unique<ThreadPool>(worker_threads_);
+    return *worker_pool_;
+}
+
+void Arena::setWorkerThreads(size_t threads) {
+    // стадии игры держат ссылку на пул, пока идёт parallelFor
+    if (running_) {
+        throw std::runtime_error("Game is already running");
     }
+    std::lock_guard<std::mutex> lock(worker_pool_mutex_);
+    worker_threads_ = threads;
+    worker_pool_.reset();
 }
 
 void Arena::startBattle(double range) {
-    CombatVisitor visitor;
-    std::vector<std::string> toRemove;
+    std::shared_lock<std::shared_mutex> lock(npcs_mutex_, std::defer_lock);
+    lockTimed(lock, metrics_.npcs_lock_wait);
+
+    // все NPC на месте, в том числе погибшие, но ещё не удалённые
+    std::vector<SpatialGrid::Entry> entries;
+    entries.reserve(npcs_.size());
+    for (uint32_t i = 0; i < npcs_.slotCount(); ++i) {
+        if (!npcs_.occupied(i)) continue;
+        NpcState::Value state = npcs_.loadState(i);
+        entries.push_back({state.x, state.y, i});
+    }
+    // при range < 0 (или NaN) в бой не вступает никто
+    if (entries.size() < 2 || !(range >= 0)) return;
+
+    // ячейка не меньше радиуса: пары на расстоянии range лежат в соседних ячейках
+    const int cellSize = static_cast<int>(std::min(std::ceil(range), static_cast<double>(INT_MAX / 2)));
+    SpatialGrid grid;
+    grid.rebuild(cellSize, entries);
+
+    // типы в порядке ячеек сетки, рядом с её координатами
+    const auto& sorted = grid.getSorted();
+    std::vector<uint8_t> types(sorted.size());
+    for (size_t k = 0; k < sorted.size(); ++k) {
+        types[k] = static_cast<uint8_t>(npcs_.getTypeId(sorted[k].id));
+    }
+    const int64_t rangeSq = squaredRange(range);
+
+    // пары сражающихся (младший слот в старших битах); каждый участок сетки
+    // пишет в свой вектор, так что параллельная фаза обходится без блокировок
+    const size_t cells = grid.getCellCount();
+    const bool parallel = entries.size() >= kParallelBattleThreshold;
+    const size_t chunks = parallel ? std::min(cells, workerPool().size() * 4) : 1;
+    std::vector<std::vector<uint64_t>> found(chunks);
+
+    auto searchChunk = [&](size_t chunk, size_t) {
+        const size_t first = cells * chunk / chunks;
+        const size_t last = cells * (chunk + 1) / chunks;
+        grid.forEachCandidateBlock(first, last, [&](uint32_t k, uint32_t begin, uint32_t end) {
+            const SpatialGrid::Entry& a = sorted[k];
+            const RangeQuery query{a.x, a.y, rangeSq, hostileTypes(static_cast<NpcType>(types[k]))};
+            forEachInRange(query, grid.getSortedX(), grid.getSortedY(), types.data(), begin, end, [&](size_t b) {
+                found[chunk].push_back(PendingPairSet::pairKey(a.id, sorted[b].id));
+            });
+        });
+    };
+    if (parallel && chunks > 1) {
+        workerPool().parallelFor(chunks, searchChunk);
+    } else {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) searchChunk(chunk, 0);
+    }
 
-    std::shared_lock<std::shared_mutex> lock(npcs_mutex_);
-    for (auto& [name1, npc1] : npcs_) {
-        for (auto& [name2, npc2] : npcs_) {
-            if (name1 == name2) continue;
-            if (name1 > name2) continue;
-
-            if (npc1->distanceTo(*npc2) > range) continue;
-            
-            bool npc1KillsNpc2 = visitor.canKill(npc1.get(), npc2.get());
-            bool npc2KillsNpc1 = visitor.canKill(npc2.get(), npc1.get());
-            
-            if (npc1KillsNpc2 && npc2KillsNpc1) {
-                std::string event = npc1->getName() + " (" + npc1->getType() + 
-                                   ") and " + npc2->getName() + " (" + npc2->getType() + 
-                                   ") killed each other";
-                notifyObservers(event);
-                toRemove.push_back(name1);
-                toRemove.push_back(name2);
-            } else if (npc1KillsNpc2) {
-                std::string event = npc1->getName() + " (" + npc1->getType() + 
-                                   ") killed " + npc2->getName() + " (" + npc2->getType() + ")";
-                notifyObservers(event);
-                toRemove.push_back(name2);
-            } else if (npc2KillsNpc1) {
-                std::string event = npc2->getName() + " (" + npc2->getType() + 
-                                   ") killed " + npc1->getName() + " (" + npc1->getType() + ")";
-                notifyObservers(event);
-                toRemove.push_back(name1);
-            }
+    // порядок событий как при полном переборе: по первому, затем по второму слоту
+    std::vector<uint64_t> pairs;
+    size_t total = 0;
+    for (const auto& part : found) total += part.size();
+    pairs.reserve(total);
+    for (const auto& part : found) pairs.insert(pairs.end(), part.begin(), part.end());
+    std::sort(pairs.begin(), pairs.end());
+
+    std::vector<NpcHandle> toRemove;
+    toRemove.reserve(pairs.size());
+    const uint64_t tick = tick_count_.load(std::memory_order_relaxed);
+    for (uint64_t key : pairs) {
+        const uint32_t first = static_cast<uint32_t>(key >> 32);
+        const uint32_t second = static_cast<uint32_t>(key);
+
+        BattleEvent event;
+        event.tick = tick;
+        event.attacker = npcs_.handleAt(first);
+        event.defender = npcs_.handleAt(second);
+        event.attacker_type = npcs_.getTypeId(first);
+        event.defender_type = npcs_.getTypeId(second);
+
+        bool attackerKills = canKill(event.attacker_type, event.defender_type);
+        bool defenderKills = canKill(event.defender_type, event.attacker_type);
+        if (attackerKills && defenderKills) {
+            event.outcome = BattleOutcome::BothDied;
+            toRemove.push_back(event.attacker);
+            toRemove.push_back(event.defender);
+        } else if (attackerKills) {
+            event.outcome = BattleOutcome::AttackerWon;
+            toRemove.push_back(event.defender);
+        } else {
+            event.outcome = BattleOutcome::DefenderWon;
+            toRemove.push_back(event.attacker);
         }
+        notifyObservers(event);
     }
     
     lock.unlock();
+    if (toRemove.empty()) return;
+    deliverPendingEvents();
     
-    std::sort(toRemove.begin(), toRemove.end());
-    toRemove.erase(std::unique(toRemove.begin(), toRemove.end()), toRemove.end());
-    
-    std::unique_lock<std::shared_mutex> write_lock(npcs_mutex_);
-    for (const auto& name : toRemove) {
-        npcs_.erase(name);
+    // erase пропускает уже удалённые дескрипторы, поэтому дубликаты безопасны
+    std::unique_lock<std::shared_mutex> write_lock(npcs_mutex_, std::defer_lock);
+    lockTimed(write_lock, metrics_.npcs_lock_wait);
+    for (const auto& handle : toRemove) {
+        if (!npcs_.valid(handle)) continue;
+        npcs_.erase(handle);
+        LAB7_METRIC_ADD(metrics_.kills, 1);
     }
+    membership_version_++;
+    snapshot_stale_ = true;
 }
 
 // методы для многопоточности
-void Arena::generateRandomNpcs(int count) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> x_dist(0, width_);
-    std::uniform_int_distribution<> y_dist(0, height_);
-    std::uniform_int_distribution<> type_dist(0, 2);
+void Arena::generateRandomNpcs(int count, bool printStats) {
+    RandomStream rng(seed_, RandomStream::Kind::Spawn, getNpcCount());
 
     const std::vector<std::string> types = {"Dragon", "Elf", "Druid"};
 
     std::map<std::string, int> type_counts = {{"Dragon", 0}, {"Elf", 0}, {"Druid", 0}};
 
     for (int i = 0; i < count; ++i) {
-        std::string type = types[type_dist(gen)];
+        std::string type = types[rng.uniform(0, 2)];
         type_counts[type]++;
         std::string name = type + "_" + std::to_string(i);
-        int x = x_dist(gen);
-        int y = y_dist(gen);
+        int x = rng.uniform(0, width_);
+        int y = rng.uniform(0, height_);
 
         try {
             createAndAddNpc(type, name, x, y);
@@ -210,6 +475,8 @@ void Arena::generateRandomNpcs(int count) {
         }
     }
 
+    if (!printStats) return;
+
     // вывод статистики
     std::cout << "\n=== NPC Generation Statistics ===" << std::endl;
     std::cout << "Dragons: " << type_counts["Dragon"] << std::endl;
@@ -220,76 +487,46 @@ void Arena::generateRandomNpcs(int count) {
 }
 
 void Arena::printMap() const {
-    std::shared_lock<std::shared_mutex> lock(npcs_mutex_);
-    std::lock_guard<std::mutex> cout_lock(cout_mutex_);
-
-    std::vector<std::vector<char>> map(height_ + 1, std::vector<char>(width_ + 1, '.'));
-
-    for (const auto& [name, npc] : npcs_) {
-        if (npc->isAlive()) {
-            int x = npc->getX();
-            int y = npc->getY();
-            if (x >= 0 && x <= width_ && y >= 0 && y <= height_) {
-                char symbol = '?';
-                if (npc->getType() == "Dragon") symbol = 'D';
-                else if (npc->getType() == "Elf") symbol = 'E';
-                else if (npc->getType() == "Druid") symbol = 'R';
-                map[y][x] = symbol;
-            }
-        }
-    }
-
-    std::cout << "\n========== MAP ==========" << std::endl;
-        
-    for (int y = height_; y >= 0; --y) {
-        std::cout << std::setw(3) << y << " | ";
-        for (int x = 0; x <= width_; ++x) {
-            std::cout << map[y][x];
-        }
-        std::cout << std::endl;
-    }
-
-    std::cout << "    +";
-    for (int x = 0; x <= width_; ++x) std::cout << "-";
-    std::cout << "+" << std::endl;
-
-    std::cout << "      ";
-    for (int x = 0; x <= width_; x += 10) {
-        if (x == 0) {
-            std::cout << "0";
-        } else {
-            std::cout << std::setw(9) << x;
+    std::lock_guard<std::mutex> render_lock(render_mutex_);
+    LAB7_METRIC_TIME(metrics_.print_lock);
+
+    {
+        // кадр строится по снимку мира, блокировка NPC не нужна
+        auto world = snapshot();
+        renderer_.beginFrame();
+        for (const auto& npc : world->npcs) {
+            if (npc.alive) renderer_.plot(npc.x, npc.y, npcTypeSymbol(npc.type));
         }
+        renderer_.setCounts(world->alive, world->npcs.size());
     }
-    std::cout << std::endl;
 
-    std::cout << "\nAlive: " << getAliveCount() << " / " << npcs_.size() << std::endl;
-    std::cout << "========================\n" << std::endl;
+    const std::string& frame = renderer_.render(map_mode_.load());
+    std::lock_guard<std::mutex> cout_lock(cout_mutex_);
+    std::cout.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+    std::cout.flush();
 }
 
 void Arena::printSurvivors() const {
-    std::shared_lock<std::shared_mutex> lock(npcs_mutex_);
+    auto world = snapshot();
     std::lock_guard<std::mutex> cout_lock(cout_mutex_);
 
     std::cout << "\n===== SURVIVORS =====" << std::endl;
     int count = 0;
-    for (const auto& [name, npc] : npcs_) {
-        if (npc->isAlive()) {
-            std::cout << *npc << std::endl;
-            count++;
-        }
+    for (const auto& npc : world->npcs) {
+        if (!npc.alive) continue;
+        writeNpcLine(std::cout, world->nameOf(npc), npc.type, npc.x, npc.y, npc.alive) << std::endl;
+        count++;
     }
     std::cout << "Total survivors: " << count << std::endl;
     std::cout << "=====================\n" << std::endl;
 }
 
 std::vector<Npc*> Arena::getAliveNpcs() const {
-    std::shared_lock<std::shared_mutex> lock(npcs_mutex_);
+    auto world = snapshot();
     std::vector<Npc*> alive;
-    for (const auto& [name, npc] : npcs_) {
-        if (npc->isAlive()) {
-            alive.push_back(npc.get());
-        }
+    alive.reserve(world->alive);
+    for (const auto& npc : world->npcs) {
+        if (npc.alive) alive.push_back(npc.object);
     }
     return alive;
 }
@@ -299,140 +536,373 @@ bool Arena::isValidPosition(int x, int y) const {
 }
 
 // ф-ции для потоков
-void Arena::movementThreadFunc() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dir_dist(-1, 1);
+void Arena::moveNpcs() {
+    const uint64_t tick = tick_count_.load(std::memory_order_relaxed);
+    const uint32_t slots = npcs_.slotCount();
+    if (slots < kParallelMovementThreshold || workerPool().size() < 2) {
+        for (uint32_t first = 0; first < slots; first += kMovementChunk) {
+            moveRange(first, std::min(slots, first + kMovementChunk), tick);
+        }
+        return;
+    }
 
-    while (running_) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // участки не пересекаются, а ход NPC зависит только от его слота и тика,
+    // поэтому результат не зависит от числа потоков и блокировки не нужны
+    const size_t chunks = (slots + kMovementChunk - 1) / kMovementChunk;
+    workerPool().parallelFor(chunks, [&](size_t chunk, size_t) {
+        const uint32_t first = static_cast<uint32_t>(chunk) * kMovementChunk;
+        moveRange(first, std::min(slots, first + kMovementChunk), tick);
+    });
+}
 
-        auto alive_npcs = getAliveNpcs();
+void Arena::moveRange(uint32_t first, uint32_t last, uint64_t tick) {
+    uint32_t moved[kMovementChunk];
+    int xs[kMovementChunk];
+    int ys[kMovementChunk];
+    uint32_t count = 0;
 
-        for (Npc* npc : alive_npcs) {
-            if (!npc->isAlive()) continue;
+    for (uint32_t i = first; i < last; ++i) {
+        if (!npcs_.occupied(i)) continue;
+        NpcState::Value state = npcs_.loadState(i);
+        if (!state.alive) continue;
 
-            int moveDistance = npc->getMoveDistance();
-            
-            int dx = dir_dist(gen) * (std::uniform_int_distribution<>(0, moveDistance)(gen));
-            int dy = dir_dist(gen) * (std::uniform_int_distribution<>(0, moveDistance)(gen));
+        int moveDistance = npcs_.getMoveDistance(i);
 
-            int newX = npc->getX() + dx;
-            int newY = npc->getY() + dy;
+        // у каждого NPC свой поток на каждый тик
+        RandomStream rng(seed_, RandomStream::Kind::Movement, i, tick);
+        int dx = rng.uniform(-1, 1) * rng.uniform(0, moveDistance);
+        int dy = rng.uniform(-1, 1) * rng.uniform(0, moveDistance);
 
-            if (isValidPosition(newX, newY)) {
-                npc->setPosition(newX, newY);
-            }
+        moved[count] = i;
+        xs[count] = state.x + dx;
+        ys[count] = state.y + dy;
+        count++;
+    }
+
+    // проверка границ всего участка разом, без ветвлений
+    uint8_t inside[kMovementChunk];
+    const auto width = static_cast<uint32_t>(width_);
+    const auto height = static_cast<uint32_t>(height_);
+    for (uint32_t k = 0; k < count; ++k) {
+        inside[k] = (static_cast<uint32_t>(xs[k]) <= width) & (static_cast<uint32_t>(ys[k]) <= height);
+    }
+
+    for (uint32_t k = 0; k < count; ++k) {
+        if (inside[k]) npcs_.setPosition(moved[k], xs[k], ys[k]);
+    }
+}
+
+void Arena::detectBattles() {
+    PhaseTimer phases(timed_tick_);
+    collectBattles(tick_count_.load(std::memory_order_relaxed), detected_battles_);
+    phases.lap(metrics_.pair_scan);
+
+    size_t total = 0;
+    for (const auto& task : detected_battles_) {
+        if (battle_queue_->push(task, running_)) total++;
+    }
+    phases.lap(metrics_.battle_queue_push);
+    if (timed_tick_) LAB7_METRIC_RECORD(metrics_.queue_depth, battle_queue_->size());
+    if (total > 0) {
+        battle_queue_->notifyAll();
+    }
+}
+
+void Arena::collectBattles(uint64_t tick, std::vector<BattleTask>& battles) {
+    battles.clear();
+    int maxKillDistance = 0;
+    grid_entries_.clear();
+    for (uint32_t i = 0; i < npcs_.slotCount(); ++i) {
+        if (!npcs_.occupied(i)) continue;
+        NpcState::Value state = npcs_.loadState(i);
+        if (!state.alive) continue;
+        maxKillDistance = std::max(maxKillDistance, npcs_.getKillDistance(i));
+        grid_entries_.push_back({state.x, state.y, i});
+    }
+    if (grid_entries_.size() < 2) return;
+
+    grid_.rebuild(maxKillDistance, grid_entries_);
+
+    const auto& sorted = grid_.getSorted();
+    grid_types_.resize(sorted.size());
+    for (size_t k = 0; k < sorted.size(); ++k) {
+        grid_types_[k] = static_cast<uint8_t>(npcs_.getTypeId(sorted[k].id));
+    }
+    const int32_t* xs = grid_.getSortedX();
+    const int32_t* ys = grid_.getSortedY();
+
+    // ядро отбирает врагов в наибольшем радиусе, точный радиус пары -
+    // больший из двух - проверяется только для отобранных
+    const int64_t maxRangeSq = static_cast<int64_t>(maxKillDistance) * maxKillDistance;
+    grid_.forEachCandidateBlock(0, grid_.getCellCount(), [&](uint32_t k, uint32_t begin, uint32_t end) {
+        const uint32_t a = sorted[k].id;
+        const RangeQuery query{xs[k], ys[k], maxRangeSq, hostileTypes(static_cast<NpcType>(grid_types_[k]))};
+        forEachInRange(query, xs, ys, grid_types_.data(), begin, end, [&](size_t j) {
+            const uint32_t b = sorted[j].id;
+            const int64_t dx = static_cast<int64_t>(xs[j]) - xs[k];
+            const int64_t dy = static_cast<int64_t>(ys[j]) - ys[k];
+            const int64_t killDist = std::max(npcs_.getKillDistance(a), npcs_.getKillDistance(b));
+            if (dx * dx + dy * dy > killDist * killDist) return;
+            battles.push_back({npcs_.handleAt(a), npcs_.handleAt(b), tick});
+        });
+    });
+}
+
+void Arena::tick() {
+    std::shared_lock<std::shared_mutex> lock(npcs_mutex_, std::defer_lock);
+    lockTimed(lock, metrics_.npcs_lock_wait);
+    timed_tick_ = isTimedTick(tick_count_.fetch_add(1, std::memory_order_relaxed) + 1);
+    LAB7_METRIC_ADD(metrics_.ticks, 1);
+    PhaseTimer phases(timed_tick_);
+    moveNpcs();
+    phases.lap(metrics_.move);
+    detectBattles();
+    snapshot_stale_ = true;
+}
+
+void Arena::moveStage(uint64_t tick) {
+    TickBuffer& buffer = tick_buffers_[tick & 1];
+    std::shared_lock<std::shared_mutex> lock(npcs_mutex_, std::defer_lock);
+    lockTimed(lock, metrics_.npcs_lock_wait);
+    buffer.tick = tick_count_.fetch_add(1, std::memory_order_relaxed) + 1;
+    timed_tick_ = isTimedTick(buffer.tick);
+    LAB7_METRIC_ADD(metrics_.ticks, 1);
+    PhaseTimer phases(timed_tick_);
+    moveNpcs();
+    phases.lap(metrics_.move);
+    collectBattles(buffer.tick, buffer.battles);
+    phases.lap(metrics_.pair_scan);
+
+    buffer.membership = membership_version_;
+    buffer.states.resize(npcs_.slotCount());
+    for (uint32_t i = 0; i < npcs_.slotCount(); ++i) {
+        buffer.states[i] = npcs_.loadState(i);
+    }
+}
+
+void Arena::combatStage(uint64_t tick) {
+    const TickBuffer& buffer = tick_buffers_[tick & 1];
+    uint64_t target;
+    {
+        std::lock_guard<std::mutex> lock(resolved_mutex_);
+        target = battles_resolved_;
+    }
+#if LAB7_ENABLE_METRICS
+    const uint64_t killsBefore = metrics_.kills.get();
+#endif
+    // бои тика раздаются потокам боёв через очередь; её ёмкость и политика
+    // переполнения действуют как прежде
+    // timed_tick_ принадлежит потоку движения, который уже ушёл на следующий тик
+    const bool timed = isTimedTick(buffer.tick);
+    {
+        LAB7_METRIC_TIME_IF(metrics_.battle_queue_push, timed);
+        for (const auto& task : buffer.battles) {
+            if (battle_queue_->push(task, running_)) target++;
         }
+    }
+    if (timed) LAB7_METRIC_RECORD(metrics_.queue_depth, battle_queue_->size());
+    battle_queue_->notifyAll();
 
-        alive_npcs = getAliveNpcs();
-        CombatVisitor visitor;
+    {
+        LAB7_METRIC_TIME_IF(metrics_.battle_wait, timed);
+        std::unique_lock<std::mutex> lock(resolved_mutex_);
+        resolved_cv_.wait(lock, [this, target] { return battles_resolved_ >= target || !running_; });
+    }
+    if (timed) LAB7_METRIC_RECORD(metrics_.kills_per_tick, metrics_.kills.get() - killsBefore);
+}
 
-        for (size_t i = 0; i < alive_npcs.size(); ++i) {
-            for (size_t j = i + 1; j < alive_npcs.size(); ++j) {
-                Npc* npc1 = alive_npcs[i];
-                Npc* npc2 = alive_npcs[j];
+void Arena::publishStage(uint64_t tick) {
+    std::shared_lock<std::shared_mutex> lock(npcs_mutex_, std::defer_lock);
+    lockTimed(lock, metrics_.npcs_lock_wait);
+    publishSnapshot(false, &tick_buffers_[tick & 1]);
+}
 
-                if (!npc1->isAlive() || !npc2->isAlive()) continue;
+void Arena::setMetricsOutput(const std::string& filename, MetricsFormat format) {
+    metrics_output_ = filename;
+    metrics_format_ = format;
+}
 
-                double distance = npc1->distanceTo(*npc2);
-                int killDist = std::max(npc1->getKillDistance(), npc2->getKillDistance());
+PipelineStats Arena::getPipelineStats() const {
+    return pipeline_ ? pipeline_->getStats() : PipelineStats{};
+}
 
-                if (distance <= killDist) {
-                    if (visitor.canKill(npc1, npc2) || visitor.canKill(npc2, npc1)) {
-                        {
-                            std::lock_guard<std::mutex> lock(battle_queue_mutex_);
-                            battle_queue_.push({npc1, npc2});
-                        }
-                        battle_cv_.notify_one();
-                    }
-                }
-            }
+void Arena::setMapRenderMode(MapRenderer::Mode mode) {
+    map_mode_ = mode;
+}
+
+void Arena::setMapViewport(int x, int y, int width, int height) {
+    if (width < 0 || height < 0) {
+        throw std::invalid_argument("Map viewport size must be non-negative.");
+    }
+    std::lock_guard<std::mutex> lock(render_mutex_);
+    // новый буфер кадра: в режиме Diff следующий кадр снова выводится целиком
+    renderer_ = MapRenderer(width, height, x, y);
+}
+
+void Arena::setSeed(uint64_t seed) {
+    if (running_) {
+        throw std::runtime_error("Game is already running");
+    }
+    seed_ = seed;
+}
+
+size_t Arena::runHeadless(uint64_t ticks) {
+    if (running_) {
+        throw std::runtime_error("Game is already running");
+    }
+
+    // бои в вызывающем потоке: порядок боёв задан порядком обнаружения;
+    // движение может идти на пуле, но от числа потоков не зависит
+    size_t battles = 0;
+    for (uint64_t i = 0; i < ticks; ++i) {
+#if LAB7_ENABLE_METRICS
+        const uint64_t killsBefore = metrics_.kills.get();
+#endif
+        tick();
+        size_t done;
+        while ((done = processBattles(0)) > 0) {
+            battles += done;
+        }
+        if (timed_tick_) LAB7_METRIC_RECORD(metrics_.kills_per_tick, metrics_.kills.get() - killsBefore);
+    }
+    snapshot_stale_ = true;
+    return battles;
+}
+
+void Arena::resolveBattle(const BattleTask& task) {
+    if (!npcs_.valid(task.attacker) || !npcs_.valid(task.defender)) return;
+
+    const uint32_t a = task.attacker.index;
+    const uint32_t d = task.defender.index;
+    if (!npcs_.isAlive(a) || !npcs_.isAlive(d)) return;
+
+    BattleEvent event;
+    event.tick = task.tick;
+    event.attacker = task.attacker;
+    event.defender = task.defender;
+    event.attacker_type = npcs_.getTypeId(a);
+    event.defender_type = npcs_.getTypeId(d);
+
+    bool attackerCanKill = canKill(event.attacker_type, event.defender_type);
+    bool defenderCanKill = canKill(event.defender_type, event.attacker_type);
+
+    RandomStream gen(seed_, RandomStream::Kind::Fight, PendingPairSet::pairKey(a, d), task.tick);
+
+    // Бои одного NPC могут одновременно идти в разных потоках. Убийство засчитывается
+    // только тому, чей kill() сработал, поэтому NPC не умирает дважды.
+    if (attackerCanKill && defenderCanKill) {
+        event.attacker_attack = rollDice(gen);
+        event.attacker_defense = rollDice(gen);
+        event.defender_attack = rollDice(gen);
+        event.defender_defense = rollDice(gen);
+
+        bool attacker_wins = event.attacker_attack > event.defender_defense && npcs_.kill(d);
+        bool defender_wins = event.defender_attack > event.attacker_defense && npcs_.kill(a);
+
+        if (attacker_wins && defender_wins) {
+            event.outcome = BattleOutcome::BothDied;
+        } else if (attacker_wins) {
+            event.outcome = BattleOutcome::AttackerWon;
+        } else if (defender_wins) {
+            event.outcome = BattleOutcome::DefenderWon;
+        } else {
+            return;
+        }
+    } else if (attackerCanKill) {
+        event.attacker_attack = rollDice(gen);
+        event.defender_defense = rollDice(gen);
+
+        if (event.attacker_attack <= event.defender_defense || !npcs_.kill(d)) return;
+        event.outcome = BattleOutcome::AttackerWon;
+    } else if (defenderCanKill) {
+        event.defender_attack = rollDice(gen);
+        event.attacker_defense = rollDice(gen);
+
+        if (event.defender_attack <= event.attacker_defense || !npcs_.kill(a)) return;
+        event.outcome = BattleOutcome::DefenderWon;
+    } else {
+        return;
+    }
+
+    LAB7_METRIC_ADD(metrics_.kills, event.outcome == BattleOutcome::BothDied ? 2 : 1);
+    notifyObservers(event);
+}
+
+void Arena::setBattleWorkers(int workers) {
+    if (running_) {
+        throw std::runtime_error("Game is already running");
+    }
+
+    // накопленные задачи отбрасываются: они относятся к старым позициям
+    battle_queue_ = std::make_unique<BattleQueue>(static_cast<size_t>(std::max(workers, 1)),
+                                                  battle_queue_config_);
+}
+
+void Arena::configureBattleQueue(const BattleQueueConfig& config) {
+    if (running_) {
+        throw std::runtime_error("Game is already running");
+    }
+
+    battle_queue_config_ = config;
+    battle_queue_ = std::make_unique<BattleQueue>(battle_queue_->getShardCount(), config);
+}
+
+size_t Arena::processBattles(size_t workerId) {
+    size_t processed = 0;
+    BattleTask task;
+
+    std::shared_lock<std::shared_mutex> lock(npcs_mutex_, std::defer_lock);
+    lockTimed(lock, metrics_.npcs_lock_wait);
+    while (processed < kBattleBatch && battle_queue_->pop(workerId, task)) {
+        resolveBattle(task);
+        battle_queue_->complete(task);
+        processed++;
+    }
+    lock.unlock();
+
+    if (processed > 0) {
+        LAB7_METRIC_ADD(metrics_.battles, processed);
+        {
+            std::lock_guard<std::mutex> resolved_lock(resolved_mutex_);
+            battles_resolved_ += processed;
         }
+        resolved_cv_.notify_all();
     }
+    return processed;
 }
 
-void Arena::battleThreadFunc() {
+void Arena::battleThreadFunc(size_t workerId) {
     while (running_) {
-        std::unique_lock<std::mutex> lock(battle_queue_mutex_);
-        battle_cv_.wait_for(lock, std::chrono::milliseconds(100), [this] { 
-            return !battle_queue_.empty() || !running_; 
-        });
+        if (processBattles(workerId) > 0) continue;
+        battle_queue_->waitForTasks(std::chrono::milliseconds(100), running_);
+    }
+}
 
-        if (!battle_queue_.empty()) {
-            BattleTask task = battle_queue_.front();
-            battle_queue_.pop();
-            lock.unlock();
-
-            Npc* attacker = task.attacker;
-            Npc* defender = task.defender;
-
-            if (!attacker->isAlive() || !defender->isAlive()) continue;
-
-            CombatVisitor visitor;
-            bool attackerCanKill = visitor.canKill(attacker, defender);
-            bool defenderCanKill = visitor.canKill(defender, attacker);
-
-            if (attackerCanKill && defenderCanKill) {
-                int attackPower1 = rollDice();
-                int defensePower1 = rollDice();
-                int attackPower2 = rollDice();
-                int defensePower2 = rollDice();
-
-                bool attacker_wins = attackPower1 > defensePower2;
-                bool defender_wins = attackPower2 > defensePower1;
-
-                if (attacker_wins && defender_wins) {
-                    attacker->kill();
-                    defender->kill();
-                    std::stringstream ss;
-                    ss << attacker->getName() << " (" << attacker->getType() 
-                       << ") and " << defender->getName() << " (" << defender->getType() 
-                       << ") killed each other [" << attackPower1 << " vs " << defensePower2 
-                       << ", " << attackPower2 << " vs " << defensePower1 << "]";
-                    notifyObservers(ss.str());
-                } else if (attacker_wins) {
-                    defender->kill();
-                    std::stringstream ss;
-                    ss << attacker->getName() << " (" << attacker->getType() 
-                       << ") killed " << defender->getName() << " (" << defender->getType() 
-                       << ") [" << attackPower1 << " > " << defensePower2 << "]";
-                    notifyObservers(ss.str());
-                } else if (defender_wins) {
-                    attacker->kill();
-                    std::stringstream ss;
-                    ss << defender->getName() << " (" << defender->getType() 
-                       << ") killed " << attacker->getName() << " (" << attacker->getType() 
-                       << ") [" << attackPower2 << " > " << defensePower1 << "]";
-                    notifyObservers(ss.str());
-                }
-            } else if (attackerCanKill) {
-                int attackPower = rollDice();
-                int defensePower = rollDice();
-
-                if (attackPower > defensePower) {
-                    defender->kill();
-                    std::stringstream ss;
-                    ss << attacker->getName() << " (" << attacker->getType() 
-                       << ") killed " << defender->getName() << " (" << defender->getType() 
-                       << ") [" << attackPower << " > " << defensePower << "]";
-                    notifyObservers(ss.str());
-                }
-            } else if (defenderCanKill) {
-                int attackPower = rollDice();
-                int defensePower = rollDice();
-
-                if (attackPower > defensePower) {
-                    attacker->kill();
-                    std::stringstream ss;
-                    ss << defender->getName() << " (" << defender->getType() 
-                       << ") killed " << attacker->getName() << " (" << attacker->getType() 
-                       << ") [" << attackPower << " > " << defensePower << "]";
-                    notifyObservers(ss.str());
-                }
+size_t Arena::drainBattles(int workers) {
+    if (running_) {
+        throw std::runtime_error("Game is already running");
+    }
+
+    workers = std::max(workers, 1);
+    const size_t queues = battle_queue_->getShardCount();
+    std::atomic<size_t> processed{0};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < workers; ++i) {
+        threads.emplace_back([this, i, queues, &processed] {
+            size_t local = 0;
+            size_t done;
+            while ((done = processBattles(i % queues)) > 0) {
+                local += done;
             }
-        }
+            processed += local;
+        });
     }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    snapshot_stale_ = true;
+    return processed;
 }
 
 void Arena::printThreadFunc(int durationSeconds) {
@@ -442,14 +912,27 @@ void Arena::printThreadFunc(int durationSeconds) {
     }
 }
 
-void Arena::startGame(int durationSeconds) {
+void Arena::startGame(int durationSeconds, int battleWorkers) {
     if (running_) {
         throw std::runtime_error("Game is already running");
     }
 
+    const size_t workers = static_cast<size_t>(std::max(battleWorkers, 1));
+    if (workers != battle_queue_->getShardCount()) {
+        setBattleWorkers(battleWorkers);
+    }
+
     running_ = true;
-    movement_thread_ = std::thread(&Arena::movementThreadFunc, this);
-    battle_thread_ = std::thread(&Arena::battleThreadFunc, this);
+    events_.start();
+    for (size_t i = 0; i < workers; ++i) {
+        battle_threads_.emplace_back(&Arena::battleThreadFunc, this, i);
+    }
+    TickPipeline::Stages stages;
+    stages.move = [this](uint64_t tick) { moveStage(tick); };
+    stages.combat = [this](uint64_t tick) { combatStage(tick); };
+    stages.publish = [this](uint64_t tick) { publishStage(tick); };
+    pipeline_ = std::make_unique<TickPipeline>(std::move(stages), kTickInterval);
+    pipeline_->start();
     print_thread_ = std::thread(&Arena::printThreadFunc, this, durationSeconds);
     print_thread_.join();
     stopGame();
@@ -458,9 +941,30 @@ void Arena::startGame(int durationSeconds) {
 void Arena::stopGame() {
     if (!running_) return;
 
+    // конвейер доводит начатый тик, пока потоки боёв ещё работают
+    pipeline_->stop();
+
     running_ = false;
-    battle_cv_.notify_all();
+    battle_queue_->notifyAll();
+    resolved_cv_.notify_all();
+
+    for (auto& thread : battle_threads_) {
+        if (thread.joinable()) thread.join();
+    }
+    battle_threads_.clear();
+    // бои после последнего тика тоже должны попасть в снимок
+    snapshot_stale_ = true;
+
+    // потоки боёв остановлены, новых событий не будет - доставляем остаток
+    events_.stop();
 
-    if (movement_thread_.joinable()) movement_thread_.join();
-    if (battle_thread_.joinable()) battle_thread_.join();
+    if (!metrics_output_.empty()) {
+        // stopGame вызывается и из деструктора, поэтому ошибка записи только выводится
+        try {
+            metrics_registry_.write(metrics_output_, metrics_format_);
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(cout_mutex_);
+            std::cerr << e.what() << std::endl;
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <chrono>
+#include "../include/batch_runner.h"
+#include "../include/arena.h"
+#include "../include/thread_pool.h"
+
+void RunningStats::add(double value) {
+    count_++;
+    if (count_ == 1) {
+        min_ = max_ = value;
+    } else {
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+    double delta = value - mean_;
+    mean_ += delta / count_;
+    m2_ += delta * (value - mean_);
+}
+
+void RunningStats::merge(const RunningStats& other) {
+    if (other.count_ == 0) return;
+    if (count_ == 0) {
+        *this = other;
+        return;
+    }
+
+    // формула Чана для объединения двух выборок
+    const size_t total = count_ + other.count_;
+    const double delta = other.mean_ - mean_;
+    mean_ += delta * other.count_ / total;
+    m2_ += other.m2_ + delta * delta * count_ * other.count_ / total;
+    count_ = total;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void BatchResult::merge(const BatchResult& other) {
+    simulations += other.simulations;
+    for (size_t t = 0; t < kNpcTypeCount; ++t) {
+        by_type[t].survivors.merge(other.by_type[t].survivors);
+        auto& histogram = by_type[t].histogram;
+        const auto& add = other.by_type[t].histogram;
+        if (histogram.size() < add.size()) histogram.resize(add.size());
+        for (size_t k = 0; k < add.size(); ++k) {
+            histogram[k] += add[k];
+        }
+    }
+    total_survivors.merge(other.total_survivors);
+    battles.merge(other.battles);
+}
+
+BatchRunner::BatchRunner(const BatchConfig& config) : config_(config) {}
+
+void BatchRunner::runOne(size_t index, BatchResult& result) const {
+    Arena arena(config_.width, config_.height);
+    arena.setSeed(config_.base_seed + index);
+    // параллельны сами симуляции, внутри каждой - один поток
+    arena.setWorkerThreads(1);
+    arena.generateRandomNpcs(config_.npc_count, false);
+    size_t battles = arena.runHeadless(config_.ticks);
+
+    std::array<size_t, kNpcTypeCount> survivors{};
+    size_t total = 0;
+    for (Npc* npc : arena.getAliveNpcs()) {
+        auto type = static_cast<size_t>(npc->getTypeId());
+        if (type < kNpcTypeCount) survivors[type]++;
+        total++;
+    }
+
+    result.simulations++;
+    for (size_t t = 0; t < kNpcTypeCount; ++t) {
+        auto& stats = result.by_type[t];
+        stats.survivors.add(static_cast<double>(survivors[t]));
+        if (stats.histogram.size() <= survivors[t]) stats.histogram.resize(survivors[t] + 1);
+        stats.histogram[survivors[t]]++;
+    }
+    result.total_survivors.add(static_cast<double>(total));
+    result.battles.add(static_cast<double>(battles));
+}
+
+BatchResult BatchRunner::run() const {
+    auto start = std::chrono::steady_clock::now();
+
+    ThreadPool pool(config_.threads);
+    // каждый исполнитель пишет только в свою частичную статистику
+    std::vector<BatchResult> partial(pool.size());
+    pool.parallelFor(config_.simulations, [&](size_t index, size_t worker) {
+        runOne(index, partial[worker]);
+    });
+
+    BatchResult result;
+    for (const auto& part : partial) {
+        result.merge(part);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
\ No newline at end of file
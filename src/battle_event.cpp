@@ -0,0 +1,64 @@
+#include "../include/battle_event.h"
+
+namespace {
+
+void appendNpc(std::string& out, NpcHandle npc, NpcType type, const BattleEventContext& context) {
+    out += context.nameOf(npc);
+    out += " (";
+    out += npcTypeName(type);
+    out += ')';
+}
+
+void appendRolls(std::string& out, uint8_t attack, uint8_t defense, const char* relation) {
+    out += std::to_string(attack);
+    out += relation;
+    out += std::to_string(defense);
+}
+
+}
+
+void appendBattleEvent(std::string& out, const BattleEvent& event, const BattleEventContext& context) {
+    const bool rolled = event.attacker_attack != 0 || event.defender_attack != 0;
+
+    switch (event.outcome) {
+        case BattleOutcome::BothDied:
+            appendNpc(out, event.attacker, event.attacker_type, context);
+            out += " and ";
+            appendNpc(out, event.defender, event.defender_type, context);
+            out += " killed each other";
+            if (rolled) {
+                out += " [";
+                appendRolls(out, event.attacker_attack, event.defender_defense, " vs ");
+                out += ", ";
+                appendRolls(out, event.defender_attack, event.attacker_defense, " vs ");
+                out += ']';
+            }
+            break;
+        case BattleOutcome::AttackerWon:
+            appendNpc(out, event.attacker, event.attacker_type, context);
+            out += " killed ";
+            appendNpc(out, event.defender, event.defender_type, context);
+            if (rolled) {
+                out += " [";
+                appendRolls(out, event.attacker_attack, event.defender_defense, " > ");
+                out += ']';
+            }
+            break;
+        case BattleOutcome::DefenderWon:
+            appendNpc(out, event.defender, event.defender_type, context);
+            out += " killed ";
+            appendNpc(out, event.attacker, event.attacker_type, context);
+            if (rolled) {
+                out += " [";
+                appendRolls(out, event.defender_attack, event.attacker_defense, " > ");
+                out += ']';
+            }
+            break;
+    }
+}
+
+std::string formatBattleEvent(const BattleEvent& event, const BattleEventContext& context) {
+    std::string text;
+    appendBattleEvent(text, event, context);
+    return text;
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include "../include/battle_queue.h"
+
+BattleQueue::BattleQueue(size_t shards, const BattleQueueConfig& config)
+    : config_(config), pending_(0), enqueued_(0), dropped_(0), coalesced_(0),
+      // бои, взятые из очереди, но ещё не разрешённые, тоже числятся ожидающими
+      pending_pairs_(2 * (config.capacity + 4096)), space_waiters_(0) {
+    shards = std::max<size_t>(shards, 1);
+    const size_t perShard = std::max<size_t>(config.capacity / shards, 2);
+    for (size_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::make_unique<MpmcRingBuffer<BattleTask>>(perShard));
+    }
+}
+
+uint64_t BattleQueue::pairKey(const BattleTask& task) {
+    return PendingPairSet::pairKey(task.attacker.index, task.defender.index);
+}
+
+size_t BattleQueue::shardOf(const BattleTask& task) const {
+    // бои одного NPC попадают к одному потоку, что снижает число конфликтов
+    return std::min(task.attacker.index, task.defender.index) % shards_.size();
+}
+
+bool BattleQueue::push(const BattleTask& task, const std::atomic<bool>& canWait) {
+    const uint64_t key = pairKey(task);
+    switch (pending_pairs_.insert(key)) {
+        case PendingPairSet::InsertResult::Duplicate:
+            coalesced_++;
+            return false;
+        case PendingPairSet::InsertResult::Full:
+            // бой нельзя отметить ожидающим - он теряется, как при переполнении
+            dropped_++;
+            return false;
+        case PendingPairSet::InsertResult::Inserted:
+            break;
+    }
+
+    MpmcRingBuffer<BattleTask>& ring = *shards_[shardOf(task)];
+
+    // счётчик растёт до записи, чтобы потребитель не увидел его отрицательным
+    pending_++;
+    bool pushed = ring.tryPush(task);
+    if (!pushed) {
+        if (config_.policy == OverflowPolicy::Drop) {
+            dropped_++;
+        } else {
+            pushed = waitForSpace(ring, task, canWait);
+        }
+    }
+
+    if (!pushed) {
+        pending_--;
+        pending_pairs_.erase(key);
+        return false;
+    }
+    enqueued_++;
+    return true;
+}
+
+bool BattleQueue::waitForSpace(MpmcRingBuffer<BattleTask>& ring, const BattleTask& task,
+                               const std::atomic<bool>& canWait) {
+    notifyAll();
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    space_waiters_++;
+    bool pushed;
+    while (!(pushed = ring.tryPush(task))) {
+        // без работающих потоков боёв место не освободится
+        if (!canWait) {
+            dropped_++;
+            break;
+        }
+        // таймаут страхует от пробуждения, разминувшегося с проверкой space_waiters_
+        space_cv_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    space_waiters_--;
+    return pushed;
+}
+
+bool BattleQueue::pop(size_t shard, BattleTask& task) {
+    const size_t count = shards_.size();
+    shard %= count;
+    for (size_t i = 0; i < count; ++i) {
+        if (shards_[(shard + i) % count]->tryPop(task)) {
+            pending_--;
+            // будить есть кого только при переполнении с Backpressure
+            if (space_waiters_.load() > 0) {
+                std::lock_guard<std::mutex> lock(wait_mutex_);
+                space_cv_.notify_one();
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void BattleQueue::complete(const BattleTask& task) {
+    pending_pairs_.erase(pairKey(task));
+}
+
+size_t BattleQueue::clear() {
+    size_t removed = 0;
+    BattleTask task;
+    for (auto& shard : shards_) {
+        while (shard->tryPop(task)) {
+            pending_--;
+            complete(task);
+            removed++;
+        }
+    }
+    return removed;
+}
+
+void BattleQueue::notifyAll() {
+    {
+        // пустой захват исключает потерю пробуждения между проверкой и ожиданием
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+    }
+    cv_.notify_all();
+    space_cv_.notify_all();
+}
+
+void BattleQueue::waitForTasks(std::chrono::milliseconds timeout, const std::atomic<bool>& running) {
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    cv_.wait_for(lock, timeout, [this, &running] {
+        return pending_.load() > 0 || !running;
+    });
+}
+
+size_t BattleQueue::getCapacity() const {
+    size_t capacity = 0;
+    for (const auto& shard : shards_) {
+        capacity += shard->capacity();
+    }
+    return capacity;
+}
+
+BattleQueueStats BattleQueue::getStats() const {
+    return {enqueued_.load(), dropped_.load(), coalesced_.load()};
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "../include/binary_snapshot.h"
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B97F4A7C15ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+
+uint64_t rotl(uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+uint64_t checksumOf(const std::vector<BinaryNpcRecord>& records, std::string_view names) {
+    uint64_t sum = snapshotChecksum(records.data(), records.size() * sizeof(BinaryNpcRecord));
+    return snapshotChecksum(names.data(), names.size(), sum);
+}
+
+}
+
+uint64_t snapshotChecksum(const void* data, size_t size, uint64_t seed) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed ^ (size * kPrime1);
+
+    size_t pos = 0;
+    for (; pos + 8 <= size; pos += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + pos, 8);
+        hash = rotl(hash ^ (word * kPrime1), 31) * kPrime2;
+    }
+    if (pos < size) {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + pos, size - pos);
+        hash = rotl(hash ^ (word * kPrime1), 31) * kPrime2;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+BinarySnapshotWriter::BinarySnapshotWriter(size_t expectedCount) {
+    records_.reserve(expectedCount);
+    names_.reserve(expectedCount * 12);
+}
+
+void BinarySnapshotWriter::add(NpcType type, std::string_view name, int x, int y, bool alive) {
+    if (name.size() > UINT16_MAX || names_.size() + name.size() > UINT32_MAX) {
+        throw std::length_error("NPC name does not fit the binary snapshot format");
+    }
+    BinaryNpcRecord record;
+    record.x = x;
+    record.y = y;
+    record.name_offset = static_cast<uint32_t>(names_.size());
+    record.name_length = static_cast<uint16_t>(name.size());
+    record.type = static_cast<uint8_t>(type);
+    record.alive = alive ? 1 : 0;
+    records_.push_back(record);
+    names_.append(name);
+}
+
+void BinarySnapshotWriter::addRemoved(std::string_view name) {
+    add(NpcType::Dragon, name, 0, 0, false);
+    records_.back().alive = kRemoved;
+}
+
+void BinarySnapshotWriter::write(const std::string& filename) const {
+    BinarySnapshotHeader header;
+    std::memcpy(header.magic, kBinarySnapshotMagic, sizeof(header.magic));
+    header.version = kBinarySnapshotVersion;
+    header.count = static_cast<uint32_t>(records_.size());
+    header.names_bytes = names_.size();
+    header.checksum = checksumOf(records_, names_);
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + filename);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records_.data()),
+               static_cast<std::streamsize>(records_.size() * sizeof(BinaryNpcRecord)));
+    file.write(names_.data(), static_cast<std::streamsize>(names_.size()));
+    if (!file) {
+        throw std::runtime_error("Failed to write snapshot: " + filename);
+    }
+}
+
+bool isBinarySnapshot(std::string_view data) {
+    return data.size() >= sizeof(kBinarySnapshotMagic) &&
+           std::memcmp(data.data(), kBinarySnapshotMagic, sizeof(kBinarySnapshotMagic)) == 0;
+}
+
+size_t parseBinarySnapshot(std::string_view data, std::vector<NpcRecord>& records, std::vector<LoadError>& errors) {
+    if (data.size() < sizeof(BinarySnapshotHeader) || !isBinarySnapshot(data)) {
+        throw std::runtime_error("Not a binary snapshot");
+    }
+    BinarySnapshotHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.version != kBinarySnapshotVersion) {
+        throw std::runtime_error("Unsupported binary snapshot version " + std::to_string(header.version));
+    }
+
+    const uint64_t recordsBytes = static_cast<uint64_t>(header.count) * sizeof(BinaryNpcRecord);
+    if (data.size() != sizeof(header) + recordsBytes + header.names_bytes) {
+        throw std::runtime_error("Binary snapshot size does not match its header");
+    }
+
+    // отображение выровнено по странице, а заголовок - по 16 байт,
+    // поэтому записи читаются на месте
+    const auto* raw = reinterpret_cast<const BinaryNpcRecord*>(data.data() + sizeof(header));
+    std::string_view names = data.substr(sizeof(header) + recordsBytes);
+
+    uint64_t sum = snapshotChecksum(raw, recordsBytes);
+    if (snapshotChecksum(names.data(), names.size(), sum) != header.checksum) {
+        throw std::runtime_error("Binary snapshot checksum mismatch");
+    }
+
+    records.reserve(records.size() + header.count);
+    for (uint32_t i = 0; i < header.count; ++i) {
+        const BinaryNpcRecord& raw_record = raw[i];
+        const size_t number = i + 1;
+        if (static_cast<uint64_t>(raw_record.name_offset) + raw_record.name_length > names.size()) {
+            errors.push_back({number, "name is outside the string table"});
+            continue;
+        }
+        if (raw_record.alive == 2) {
+            NpcRecord record;
+            record.type = NpcType::Unknown;
+            record.name = names.substr(raw_record.name_offset, raw_record.name_length);
+            record.x = 0;
+            record.y = 0;
+            record.alive = false;
+            record.removed = true;
+            record.line = number;
+            records.push_back(record);
+            continue;
+        }
+        if (raw_record.type >= kNpcTypeCount) {
+            errors.push_back({number, "unknown NPC type"});
+            continue;
+        }
+        if (raw_record.x < 0 || raw_record.y < 0) {
+            errors.push_back({number, "coordinates must be non-negative"});
+            continue;
+        }
+
+        NpcRecord record;
+        record.type = static_cast<NpcType>(raw_record.type);
+        record.name = names.substr(raw_record.name_offset, raw_record.name_length);
+        record.x = raw_record.x;
+        record.y = raw_record.y;
+        record.alive = raw_record.alive != 0;
+        record.line = number;
+        records.push_back(record);
+    }
+    return header.count;
+}
\ No newline at end of file
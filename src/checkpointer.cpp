@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include "../include/checkpointer.h"
+#include "../include/arena.h"
+#include "../include/binary_snapshot.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const kManifest = "manifest.txt";
+
+std::string checkpointFile(const std::string& directory, uint64_t sequence) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "checkpoint_%08llu.bin", static_cast<unsigned long long>(sequence));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+// номер точки из имени файла, 0 - не файл точки
+uint64_t sequenceOf(const std::filesystem::path& path) {
+    unsigned long long sequence = 0;
+    char tail = 0;
+    if (std::sscanf(path.filename().c_str(), "checkpoint_%llu.bi%c", &sequence, &tail) != 2 || tail != 'n') {
+        return 0;
+    }
+    return sequence;
+}
+
+void addEntry(BinarySnapshotWriter& writer, const WorldSnapshot& world, const WorldSnapshot::Entry& entry) {
+    writer.add(entry.type, world.nameOf(entry), entry.x, entry.y, entry.alive);
+}
+
+}
+
+Checkpointer::Checkpointer(const Arena& arena, CheckpointConfig config)
+    : arena_(arena), config_(std::move(config)), running_(false) {
+    if (config_.full_every == 0) config_.full_every = 1;
+    // в каталоге могут остаться точки прошлой игры: номера продолжаются после них,
+    // чтобы не перезаписать файлы, на которые ещё указывает старый манифест
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(config_.directory, error)) {
+        sequence_ = std::max(sequence_, sequenceOf(file.path()));
+    }
+}
+
+Checkpointer::~Checkpointer() {
+    if (thread_.joinable()) stop();
+}
+
+void Checkpointer::start() {
+    if (thread_.joinable()) return;
+    running_ = true;
+    thread_ = std::thread(&Checkpointer::threadFunc, this);
+}
+
+void Checkpointer::stop() {
+    if (!thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        running_ = false;
+    }
+    wake_cv_.notify_all();
+    thread_.join();
+    // stop() зовёт и деструктор: ошибка последней записи только считается
+    try {
+        checkpointNow();
+    } catch (const std::exception&) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        stats_.failures++;
+    }
+}
+
+void Checkpointer::threadFunc() {
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, config_.interval, [this] { return !running_; });
+        }
+        if (!running_) break;
+        try {
+            checkpointNow();
+        } catch (const std::exception&) {
+            // ошибка записи не должна ронять игру; следующая попытка через interval
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            stats_.failures++;
+        }
+    }
+}
+
+void Checkpointer::checkpointNow() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    auto start = Clock::now();
+
+    const uint64_t sequence = ++sequence_;
+    const bool full = last_full_ == 0 || sequence - last_full_ >= config_.full_every;
+    uint64_t tick;
+    // база следующей дельты меняется только после успешной записи
+    std::vector<WorldSnapshot::Entry> captured;
+    std::shared_ptr<const std::vector<std::string>> capturedNames;
+
+    BinarySnapshotWriter writer(full ? previous_.size() : 0);
+    {
+        // захват - только указатель на уже опубликованный снимок
+        auto world = arena_.snapshot();
+        const auto& current = world->npcs;
+        tick = world->tick;
+
+        if (full) {
+            for (const auto& entry : current) addEntry(writer, *world, entry);
+        } else {
+            // обе последовательности идут в порядке слотов
+            size_t i = 0;
+            size_t j = 0;
+            while (i < previous_.size() || j < current.size()) {
+                if (j == current.size() ||
+                    (i < previous_.size() && previous_[i].handle.index < current[j].handle.index)) {
+                    writer.addRemoved((*previous_names_)[previous_[i].handle.index]);
+                    ++i;
+                } else if (i == previous_.size() || current[j].handle.index < previous_[i].handle.index) {
+                    addEntry(writer, *world, current[j]);
+                    ++j;
+                } else {
+                    const auto& before = previous_[i];
+                    const auto& after = current[j];
+                    if (before.handle.generation != after.handle.generation) {
+                        writer.addRemoved((*previous_names_)[before.handle.index]);
+                        addEntry(writer, *world, after);
+                    } else if (before.x != after.x || before.y != after.y || before.alive != after.alive) {
+                        addEntry(writer, *world, after);
+                    }
+                    ++i;
+                    ++j;
+                }
+            }
+        }
+
+        captured = current;
+        capturedNames = world->names;
+    }
+
+    const std::string path = checkpointFile(config_.directory, sequence);
+    writer.write(path);
+
+    // манифест и база дельт меняются вместе и только после записи манифеста:
+    // при ошибке следующая дельта считается от прежней базы
+    std::vector<std::string> manifest;
+    if (!full) manifest = manifest_;
+    manifest.push_back((full ? "full " : "delta ") + std::to_string(sequence) + " " + std::to_string(tick));
+    writeManifest(manifest);
+
+    manifest_ = std::move(manifest);
+    if (full) last_full_ = sequence;
+    previous_ = std::move(captured);
+    previous_names_ = std::move(capturedNames);
+    // старые файлы, включая оставшиеся от прошлой игры, не нужны, как только
+    // манифест указывает на новый полный снимок
+    if (full) removeOlderThan(sequence);
+
+    (full ? stats_.full : stats_.deltas)++;
+    stats_.bytes += std::filesystem::file_size(path);
+    stats_.last_write = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+}
+
+CheckpointStats Checkpointer::getStats() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return stats_;
+}
+
+void Checkpointer::writeManifest(const std::vector<std::string>& manifest) const {
+    const auto directory = std::filesystem::path(config_.directory);
+    const auto temporary = directory / "manifest.tmp";
+    {
+        std::ofstream file(temporary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open file for writing: " + temporary.string());
+        }
+        file << "seed " << arena_.getSeed() << '\n';
+        for (const auto& line : manifest) {
+            file << line << '\n';
+        }
+        if (!file) {
+            throw std::runtime_error("Failed to write checkpoint manifest");
+        }
+    }
+    // переименование атомарно: читатель видит либо старый, либо новый манифест
+    std::filesystem::rename(temporary, directory / kManifest);
+}
+
+void Checkpointer::removeOlderThan(uint64_t sequence) const {
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(config_.directory, error)) {
+        uint64_t number = sequenceOf(file.path());
+        if (number != 0 && number < sequence) {
+            std::filesystem::remove(file.path(), error);
+        }
+    }
+}
+
+CheckpointData readCheckpoint(const std::string& directory) {
+    const auto manifestPath = std::filesystem::path(directory) / kManifest;
+    std::ifstream manifest(manifestPath);
+    if (!manifest.is_open()) {
+        throw std::runtime_error("Failed to open file for reading: " + manifestPath.string());
+    }
+
+    CheckpointData data;
+    struct Point {
+        bool full;
+        uint64_t sequence;
+        uint64_t tick;
+    };
+    std::vector<Point> points;
+    std::string line;
+    while (std::getline(manifest, line)) {
+        std::istringstream iss(line);
+        std::string kind;
+        iss >> kind;
+        if (kind == "seed") {
+            iss >> data.seed;
+        } else if (kind == "full" || kind == "delta") {
+            Point point{kind == "full", 0, 0};
+            iss >> point.sequence >> point.tick;
+            if (!iss.fail()) points.push_back(point);
+        }
+    }
+    if (points.empty() || !points.front().full) {
+        throw std::runtime_error("Checkpoint manifest has no full snapshot: " + manifestPath.string());
+    }
+
+    // состояние NPC по имени в порядке первого появления
+    struct State {
+        NpcType type;
+        int x;
+        int y;
+        bool alive;
+        bool present;
+    };
+    std::vector<State> states;
+    std::vector<std::string_view> names;
+    // ключи указывают в отображённые файлы, которые живут вместе с data
+    std::unordered_map<std::string_view, size_t> byName;
+
+    for (const Point& point : points) {
+        std::vector<NpcRecord> records;
+        try {
+            auto file = std::make_unique<MappedFile>(checkpointFile(directory, point.sequence));
+            std::vector<LoadError> errors;
+            parseBinarySnapshot(file->view(), records, errors);
+            for (const auto& error : errors) {
+                data.errors.push_back({point.sequence, "record " + std::to_string(error.line) + ": " + error.message});
+            }
+            data.bytes += file->size();
+            data.files.push_back(std::move(file));
+            if (point.full) byName.reserve(records.size());
+
+            // удаления раньше вставок: имя могло освободиться и занять другой слот
+            for (const auto& record : records) {
+                if (!record.removed) continue;
+                auto it = byName.find(record.name);
+                if (it != byName.end()) states[it->second].present = false;
+            }
+            for (const auto& record : records) {
+                if (record.removed) continue;
+                State state{record.type, record.x, record.y, record.alive, true};
+                auto [it, inserted] = byName.try_emplace(record.name, states.size());
+                if (inserted) {
+                    names.push_back(record.name);
+                    states.push_back(state);
+                } else {
+                    states[it->second] = state;
+                }
+            }
+        } catch (const std::exception& e) {
+            // полный снимок обязателен; дельты после испорченной применить нельзя
+            if (point.full) throw;
+            data.errors.push_back({point.sequence, e.what()});
+            break;
+        }
+        data.tick = point.tick;
+    }
+
+    data.records.reserve(states.size());
+    for (size_t i = 0; i < states.size(); ++i) {
+        if (!states[i].present) continue;
+        NpcRecord record;
+        record.type = states[i].type;
+        record.name = names[i];
+        record.x = states[i].x;
+        record.y = states[i].y;
+        record.alive = states[i].alive;
+        record.line = data.records.size() + 1;
+        data.records.push_back(record);
+    }
+    return data;
+}
\ No newline at end of file
@@ -3,16 +3,13 @@
 #include <iostream>
 #include <random>
 
-const std::string Dragon::kType = "Dragon";
-
-Dragon::Dragon(int x, int y, const std::string& name)
-    : Npc(x, y, kType, name) {}
+Dragon::Dragon(int x, int y, std::string_view name, std::pmr::memory_resource* resource)
+    : Npc(x, y, NpcType::Dragon, name, resource) {}
 
 void Dragon::accept(Visitor& visitor) {
     visitor.visit(*this);
 }
 
 void Dragon::printInfo() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::cout << "Dragon " << getName() << " at (" << getX() << ", " << getY() << ")" << std::endl;
 }
\ No newline at end of file
@@ -2,16 +2,13 @@
 #include "../include/visitor.h"
 #include <iostream>
 
-const std::string Druid::kType = "Druid";
-
-Druid::Druid(int x, int y, const std::string& name)
-    : Npc(x, y, kType, name) {}
+Druid::Druid(int x, int y, std::string_view name, std::pmr::memory_resource* resource)
+    : Npc(x, y, NpcType::Druid, name, resource) {}
 
 void Druid::accept(Visitor& visitor) {
     visitor.visit(*this);
 }
 
 void Druid::printInfo() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::cout << "Druid " << getName() << " at (" << getX() << ", " << getY() << ")" << std::endl;
 }
\ No newline at end of file
@@ -2,16 +2,13 @@
 #include "../include/visitor.h"
 #include <iostream>
 
-const std::string Elf::kType = "Elf";
-
-Elf::Elf(int x, int y, const std::string& name)
-    : Npc(x, y, kType, name) {}
+Elf::Elf(int x, int y, std::string_view name, std::pmr::memory_resource* resource)
+    : Npc(x, y, NpcType::Elf, name, resource) {}
 
 void Elf::accept(Visitor& visitor) {
     visitor.visit(*this);
 }
 
 void Elf::printInfo() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::cout << "Elf " << getName() << " at (" << getX() << ", " << getY() << ")" << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include "../include/event_bus.h"
+
+namespace {
+
+// контекст по умолчанию: имён нет
+class EmptyContext : public BattleEventContext {
+    public:
+        std::string_view nameOf(NpcHandle) const override { return {}; }
+};
+
+const EmptyContext kEmptyContext;
+
+}
+
+EventBus::EventBus(size_t capacity)
+    : queue_(capacity), battles_(capacity), context_(&kEmptyContext), running_(false),
+      flush_interval_(std::chrono::milliseconds(50)), flush_requested_(false),
+      published_(0), delivered_(0), batches_(0) {}
+
+EventBus::~EventBus() {
+    stop();
+}
+
+void EventBus::addObserver(std::shared_ptr<Observer> observer) {
+    std::lock_guard<std::mutex> lock(observers_mutex_);
+    observers_.push_back(std::move(observer));
+}
+
+void EventBus::removeObserver(const std::shared_ptr<Observer>& observer) {
+    std::lock_guard<std::mutex> lock(observers_mutex_);
+    auto it = std::find(observers_.begin(), observers_.end(), observer);
+    if (it != observers_.end()) {
+        observers_.erase(it);
+    }
+}
+
+void EventBus::publish(std::string event) {
+    published_++;
+
+    if (!running_) {
+        std::lock_guard<std::mutex> lock(observers_mutex_);
+        for (auto& observer : observers_) {
+            observer->notify(event);
+        }
+        delivered_++;
+        return;
+    }
+
+    // события не теряются: при полном буфере ждём диспетчера
+    while (!queue_.tryPush(std::move(event))) {
+        wakeDispatcher();
+        std::this_thread::yield();
+    }
+    if (queue_.size() >= queue_.capacity() / 2) {
+        wakeDispatcher();
+    }
+}
+
+void EventBus::publish(const BattleEvent& event) {
+    published_++;
+
+    if (!running_) {
+        // синхронная доставка идёт в потоке боя, который уже держит данные NPC,
+        // поэтому контекст не захватывается
+        std::lock_guard<std::mutex> lock(observers_mutex_);
+        for (auto& observer : observers_) {
+            observer->onBattle(event, *context_);
+        }
+        delivered_++;
+        return;
+    }
+
+    while (!battles_.tryPush(event)) {
+        wakeDispatcher();
+        std::this_thread::yield();
+    }
+    if (battles_.size() >= battles_.capacity() / 2) {
+        wakeDispatcher();
+    }
+}
+
+void EventBus::waitUntilDelivered() {
+    const size_t target = published_;
+    std::unique_lock<std::mutex> lock(delivered_mutex_);
+    while (running_ && delivered_ < target) {
+        flush_requested_ = true;
+        wakeDispatcher();
+        delivered_cv_.wait(lock, [this, target] { return !running_ || delivered_ >= target; });
+    }
+}
+
+void EventBus::start() {
+    if (running_) return;
+    running_ = true;
+    dispatcher_ = std::thread(&EventBus::dispatcherThreadFunc, this);
+}
+
+void EventBus::stop() {
+    if (!running_) return;
+    running_ = false;
+    wakeDispatcher();
+    notifyDelivered();
+    if (dispatcher_.joinable()) dispatcher_.join();
+}
+
+void EventBus::wakeDispatcher() {
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+    }
+    cv_.notify_one();
+}
+
+void EventBus::notifyDelivered() {
+    {
+        std::lock_guard<std::mutex> lock(delivered_mutex_);
+    }
+    delivered_cv_.notify_all();
+}
+
+bool EventBus::hasBacklog() const {
+    return flush_requested_ || queue_.size() >= queue_.capacity() / 2 ||
+           battles_.size() >= battles_.capacity() / 2;
+}
+
+void EventBus::dispatcherThreadFunc() {
+    std::vector<std::string> batch;
+    std::vector<BattleEvent> battles;
+
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            cv_.wait_for(lock, flush_interval_.load(), [this] {
+                return !running_ || hasBacklog();
+            });
+        }
+        flush_requested_ = false;
+        dispatchPending(batch, battles);
+    }
+
+    // stop(): производители уже остановлены, доставляем остаток
+    while (dispatchPending(batch, battles)) {
+    }
+
+    std::lock_guard<std::mutex> lock(observers_mutex_);
+    for (auto& observer : observers_) {
+        observer->flush();
+    }
+}
+
+bool EventBus::dispatchPending(std::vector<std::string>& batch, std::vector<BattleEvent>& battles) {
+    batch.clear();
+    std::string event;
+    while (batch.size() < queue_.capacity() && queue_.tryPop(event)) {
+        batch.push_back(std::move(event));
+    }
+
+    battles.clear();
+    BattleEvent battle;
+    while (battles.size() < battles_.capacity() && battles_.tryPop(battle)) {
+        battles.push_back(battle);
+    }
+
+    deliver(batch, battles);
+    return !batch.empty() || !battles.empty();
+}
+
+void EventBus::deliver(const std::vector<std::string>& batch, const std::vector<BattleEvent>& battles) {
+    std::lock_guard<std::mutex> lock(observers_mutex_);
+    if (!battles.empty()) {
+        context_->lock();
+    }
+    for (auto& observer : observers_) {
+        if (!batch.empty()) {
+            observer->notifyBatch(batch);
+        }
+        if (!battles.empty()) {
+            observer->onBattleBatch(battles, *context_);
+        }
+        observer->poll();
+    }
+    if (!battles.empty()) {
+        context_->unlock();
+    }
+
+    const size_t count = batch.size() + battles.size();
+    if (count > 0) {
+        delivered_ += count;
+        batches_++;
+        notifyDelivered();
+    }
+}
\ No newline at end of file
@@ -24,6 +24,15 @@ std::unique_ptr<Npc> NpcFactory::createNpc(
     }
 }
 
+std::unique_ptr<Npc> NpcFactory::createNpc(NpcType type, const std::string& name, int x, int y) {
+    switch (type) {
+        case NpcType::Dragon: return std::make_unique<Dragon>(x, y, name);
+        case NpcType::Elf: return std::make_unique<Elf>(x, y, name);
+        case NpcType::Druid: return std::make_unique<Druid>(x, y, name);
+        default: return nullptr;
+    }
+}
+
 std::unique_ptr<Npc> NpcFactory::createFromString(const std::string& line) {
     std::istringstream iss(line);
     std::string type, name;
@@ -35,8 +44,9 @@ std::unique_ptr<Npc> NpcFactory::createFromString(const std::string& line) {
         throw std::runtime_error("Failed to parse line: " + line);
     }
 
-    if (x < 0 || x > 500 || y < 0 || y > 500) {
-        throw std::out_of_range("Coordinates out of range (0-500): " + line);
+    // верхнюю границу проверяет арена: размер карты знает только она
+    if (x < 0 || y < 0) {
+        throw std::out_of_range("Coordinates must be non-negative: " + line);
     }
 
     return createNpc(type, name, x, y);
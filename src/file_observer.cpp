@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cstdio>
+#include "../include/file_observer.h"
+
+FileObserver::FileObserver(const std::string& filename, FileObserverConfig config)
+    : filename_(filename), config_(config), last_flush_(Clock::now()) {
+    buffer_.reserve(config_.buffer_size);
+    open(std::ios::app);
+}
+
+FileObserver::~FileObserver() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushLocked();
+}
+
+void FileObserver::open(std::ios::openmode mode) {
+    file_.open(filename_, std::ios::out | std::ios::binary | mode);
+    file_size_ = 0;
+    if (file_.is_open() && (mode & std::ios::app)) {
+        file_.seekp(0, std::ios::end);
+        auto end = file_.tellp();
+        if (end > 0) file_size_ = static_cast<size_t>(end);
+    }
+}
+
+void FileObserver::notify(const std::string& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    append(event);
+    flushIfDue();
+}
+
+void FileObserver::notifyBatch(const std::vector<std::string>& events) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& event : events) {
+        append(event);
+    }
+    flushIfDue();
+}
+
+void FileObserver::onBattle(const BattleEvent& event, const BattleEventContext& context) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    appendBattle(event, context);
+    flushIfDue();
+}
+
+void FileObserver::onBattleBatch(const std::vector<BattleEvent>& events, const BattleEventContext& context) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& event : events) {
+        appendBattle(event, context);
+    }
+    flushIfDue();
+}
+
+void FileObserver::poll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushIfDue();
+}
+
+void FileObserver::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushLocked();
+}
+
+FileObserverStats FileObserver::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void FileObserver::append(const std::string& event) {
+    // большой буфер не должен расти бесконечно между проверками
+    if (buffer_.size() + event.size() + 1 > config_.buffer_size && !buffer_.empty()) {
+        flushLocked();
+    }
+    buffer_ += event;
+    buffer_ += '\n';
+}
+
+void FileObserver::appendBattle(const BattleEvent& event, const BattleEventContext& context) {
+    // текст собирается сразу в буфере файла, без промежуточной строки
+    appendBattleEvent(buffer_, event, context);
+    buffer_ += '\n';
+    if (buffer_.size() >= config_.buffer_size) {
+        flushLocked();
+    }
+}
+
+void FileObserver::flushIfDue() {
+    if (buffer_.empty()) return;
+    if (buffer_.size() >= config_.buffer_size ||
+        Clock::now() - last_flush_ >= config_.flush_interval) {
+        flushLocked();
+    }
+}
+
+void FileObserver::flushLocked() {
+    last_flush_ = Clock::now();
+    if (buffer_.empty()) return;
+
+    auto start = Clock::now();
+    if (config_.rotate_size > 0 && file_size_ > 0 &&
+        file_size_ + buffer_.size() > config_.rotate_size) {
+        rotateLocked();
+    }
+    if (file_.is_open()) {
+        file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        file_.flush();
+        file_size_ += buffer_.size();
+        stats_.bytes_written += buffer_.size();
+    }
+    buffer_.clear();
+
+    auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    stats_.flushes++;
+    stats_.last_flush_latency = latency;
+    stats_.max_flush_latency = std::max(stats_.max_flush_latency, latency);
+    stats_.total_flush_latency += latency;
+}
+
+void FileObserver::rotateLocked() {
+    file_.close();
+
+    // filename.N-1 -> filename.N, ..., filename -> filename.1
+    if (config_.max_rotated_files > 0) {
+        std::remove((filename_ + "." + std::to_string(config_.max_rotated_files)).c_str());
+        for (size_t i = config_.max_rotated_files; i > 1; --i) {
+            std::rename((filename_ + "." + std::to_string(i - 1)).c_str(),
+                        (filename_ + "." + std::to_string(i)).c_str());
+        }
+        std::rename(filename_.c_str(), (filename_ + ".1").c_str());
+    }
+
+    open(std::ios::trunc);
+    stats_.rotations++;
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cstdio>
+#include "../include/map_renderer.h"
+
+MapRenderer::MapRenderer(int width, int height, int originX, int originY)
+    : width_(width), height_(height), origin_x_(originX), origin_y_(originY),
+      columns_(static_cast<size_t>(width) + 1),
+      label_width_(std::max<int>(3, static_cast<int>(std::to_string(originY + height).size()))),
+      frame_(columns_ * (height + 1), kEmpty), shown_(frame_.size(), kEmpty) {}
+
+void MapRenderer::beginFrame() {
+    // занятые в прошлом кадре клетки - единственные непустые
+    for (uint32_t cell : plotted_) {
+        frame_[cell] = kEmpty;
+    }
+    previous_.swap(plotted_);
+    plotted_.clear();
+}
+
+void MapRenderer::plot(int x, int y, char symbol) {
+    x -= origin_x_;
+    y -= origin_y_;
+    if (x < 0 || x > width_ || y < 0 || y > height_) return;
+    uint32_t cell = static_cast<uint32_t>(y * columns_ + x);
+    frame_[cell] = symbol;
+    plotted_.push_back(cell);
+}
+
+void MapRenderer::setCounts(size_t alive, size_t total) {
+    alive_ = alive;
+    total_ = total;
+}
+
+void MapRenderer::collectChanges() {
+    changed_.clear();
+    // изменения возможны только в клетках, занятых сейчас или в прошлом кадре
+    for (const auto* cells : {&previous_, &plotted_}) {
+        for (uint32_t cell : *cells) {
+            if (shown_[cell] != frame_[cell]) {
+                shown_[cell] = frame_[cell];
+                changed_.push_back(cell);
+            }
+        }
+    }
+}
+
+const std::string& MapRenderer::render(Mode mode) {
+    out_.clear();
+    collectChanges();
+
+    if (mode == Mode::Diff && screen_ready_) {
+        renderDiff();
+        return out_;
+    }
+
+    if (mode == Mode::Diff) {
+        // первый кадр на чистом экране, дальше клетки адресуются от его начала
+        out_ += "\x1b[2J\x1b[H";
+    }
+    renderFull();
+    screen_ready_ = mode == Mode::Diff;
+    return out_;
+}
+
+void MapRenderer::renderFull() {
+    out_.reserve((columns_ + 8) * (height_ + 8));
+    out_ += "\n========== MAP ==========\n";
+
+    char label[32];
+    for (int y = height_; y >= 0; --y) {
+        std::snprintf(label, sizeof(label), "%*d | ", label_width_, origin_y_ + y);
+        out_ += label;
+        out_.append(&frame_[y * columns_], columns_);
+        out_ += '\n';
+    }
+
+    out_.append(label_width_ + 1, ' ');
+    out_ += '+';
+    out_.append(columns_, '-');
+    out_ += "+\n";
+
+    // подпись каждого десятого столбца заканчивается перед ним, первая начинается с него
+    std::string axis(columns_ + 16, ' ');
+    size_t used = 0;
+    for (int x = 0; x <= width_; x += 10) {
+        std::string text = std::to_string(origin_x_ + x);
+        size_t start = x == 0 ? 0 : static_cast<size_t>(x) - std::min(text.size(), static_cast<size_t>(x));
+        if (x != 0 && start < used) continue;
+        axis.replace(start, text.size(), text);
+        used = start + text.size() + 1;
+    }
+    axis.resize(axis.find_last_not_of(' ') + 1);
+    out_.append(label_width_ + 3, ' ');
+    out_ += axis;
+    out_ += '\n';
+
+    appendStatus();
+}
+
+void MapRenderer::renderDiff() {
+    char move[32];
+    for (uint32_t cell : changed_) {
+        int x = static_cast<int>(cell % columns_);
+        int y = static_cast<int>(cell / columns_);
+        std::snprintf(move, sizeof(move), "\x1b[%d;%dH", screenRow(y), screenColumn(x));
+        out_ += move;
+        out_ += frame_[cell];
+    }
+
+    // строка счётчиков стоит через пустую строку после оси
+    std::snprintf(move, sizeof(move), "\x1b[%d;1H\x1b[J", screenRow(0) + 3);
+    out_ += move;
+    appendStatus();
+}
+
+void MapRenderer::appendStatus() {
+    out_ += "\nAlive: ";
+    out_ += std::to_string(alive_);
+    out_ += " / ";
+    out_ += std::to_string(total_);
+    out_ += "\n========================\n\n";
+}
\ No newline at end of file
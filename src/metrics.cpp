@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include "../include/metrics.h"
+
+namespace {
+
+std::string formatNumber(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+std::string scaled(uint64_t value, double scale) {
+    return scale == 1.0 ? std::to_string(value) : formatNumber(static_cast<double>(value) * scale);
+}
+
+void appendJsonString(std::string& out, std::string_view text) {
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    out += '"';
+}
+
+}
+
+void Histogram::record(uint64_t value) {
+    const size_t index = value == 0 ? 0 : 64 - static_cast<size_t>(__builtin_clzll(value));
+    buckets_[index].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t current = max_.load(std::memory_order_relaxed);
+    while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::count() const {
+    uint64_t total = 0;
+    for (const auto& bucket : buckets_) total += bucket.load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t Histogram::bucketLimit(size_t index) {
+    if (index == 0) return 0;
+    if (index >= 64) return UINT64_MAX;
+    return (uint64_t{1} << index) - 1;
+}
+
+uint64_t Histogram::quantile(double q) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+    const auto rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += bucket(i);
+        if (seen >= rank) return std::min(bucketLimit(i), max());
+    }
+    return max();
+}
+
+Histogram& MetricsRegistry::histogram(std::string name, std::string help, double scale) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Histogram& histogram = histograms_.emplace_back();
+    entries_.push_back({Kind::Histogram, std::move(name), std::move(help), scale, nullptr, nullptr, &histogram});
+    return histogram;
+}
+
+Counter& MetricsRegistry::counter(std::string name, std::string help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Counter& counter = counters_.emplace_back();
+    entries_.push_back({Kind::Counter, std::move(name), std::move(help), 1.0, &counter, nullptr, nullptr});
+    return counter;
+}
+
+Gauge& MetricsRegistry::gauge(std::string name, std::string help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Gauge& gauge = gauges_.emplace_back();
+    entries_.push_back({Kind::Gauge, std::move(name), std::move(help), 1.0, nullptr, &gauge, nullptr});
+    return gauge;
+}
+
+const MetricsRegistry::Entry* MetricsRegistry::find(std::string_view name, Kind kind) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Entry& entry : entries_) {
+        if (entry.kind == kind && entry.name == name) return &entry;
+    }
+    return nullptr;
+}
+
+const Histogram* MetricsRegistry::findHistogram(std::string_view name) const {
+    const Entry* entry = find(name, Kind::Histogram);
+    return entry ? entry->histogram : nullptr;
+}
+
+const Counter* MetricsRegistry::findCounter(std::string_view name) const {
+    const Entry* entry = find(name, Kind::Counter);
+    return entry ? entry->counter : nullptr;
+}
+
+const Gauge* MetricsRegistry::findGauge(std::string_view name) const {
+    const Entry* entry = find(name, Kind::Gauge);
+    return entry ? entry->gauge : nullptr;
+}
+
+std::string MetricsRegistry::toPrometheus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    for (const Entry& entry : entries_) {
+        out += "# HELP " + entry.name + " " + entry.help + "\n";
+        switch (entry.kind) {
+            case Kind::Counter:
+                out += "# TYPE " + entry.name + " counter\n";
+                out += entry.name + " " + std::to_string(entry.counter->get()) + "\n";
+                break;
+            case Kind::Gauge:
+                out += "# TYPE " + entry.name + " gauge\n";
+                out += entry.name + " " + std::to_string(entry.gauge->get()) + "\n";
+                break;
+            case Kind::Histogram: {
+                const Histogram& histogram = *entry.histogram;
+                out += "# TYPE " + entry.name + " histogram\n";
+                // пустые корзины после последней занятой не выводятся, последнюю заменяет +Inf
+                size_t last = 0;
+                for (size_t i = 0; i + 1 < Histogram::kBuckets; ++i) {
+                    if (histogram.bucket(i) != 0) last = i;
+                }
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i <= last; ++i) {
+                    cumulative += histogram.bucket(i);
+                    out += entry.name + "_bucket{le=\"" + scaled(Histogram::bucketLimit(i), entry.scale) + "\"} " +
+                           std::to_string(cumulative) + "\n";
+                }
+                out += entry.name + "_bucket{le=\"+Inf\"} " + std::to_string(histogram.count()) + "\n";
+                out += entry.name + "_sum " + scaled(histogram.sum(), entry.scale) + "\n";
+                out += entry.name + "_count " + std::to_string(histogram.count()) + "\n";
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+std::string MetricsRegistry::toJson() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out = "{";
+    bool first = true;
+    for (const Entry& entry : entries_) {
+        if (!first) out += ",";
+        first = false;
+        out += "\n  ";
+        appendJsonString(out, entry.name);
+        out += ": ";
+        switch (entry.kind) {
+            case Kind::Counter:
+                out += std::to_string(entry.counter->get());
+                break;
+            case Kind::Gauge:
+                out += std::to_string(entry.gauge->get());
+                break;
+            case Kind::Histogram: {
+                const Histogram& histogram = *entry.histogram;
+                out += "{\"count\": " + std::to_string(histogram.count());
+                out += ", \"sum\": " + scaled(histogram.sum(), entry.scale);
+                out += ", \"max\": " + scaled(histogram.max(), entry.scale);
+                out += ", \"p50\": " + scaled(histogram.quantile(0.5), entry.scale);
+                out += ", \"p99\": " + scaled(histogram.quantile(0.99), entry.scale);
+                // занятые корзины: [верхняя граница, число значений]
+                out += ", \"buckets\": [";
+                bool firstBucket = true;
+                for (size_t i = 0; i < Histogram::kBuckets; ++i) {
+                    if (histogram.bucket(i) == 0) continue;
+                    if (!firstBucket) out += ", ";
+                    firstBucket = false;
+                    out += "[" + scaled(Histogram::bucketLimit(i), entry.scale) + ", " +
+                           std::to_string(histogram.bucket(i)) + "]";
+                }
+                out += "]}";
+                break;
+            }
+        }
+    }
+    out += "\n}\n";
+    return out;
+}
+
+void MetricsRegistry::write(const std::string& filename, MetricsFormat format) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + filename);
+    }
+    file << (format == MetricsFormat::Json ? toJson() : toPrometheus());
+    if (!file) {
+        throw std::runtime_error("Failed to write metrics: " + filename);
+    }
+}
\ No newline at end of file
@@ -1,73 +1,78 @@
 #include "../include/npc.h"
+#include "../include/npc_store.h"
 #include <cmath>
 #include <iostream>
 #include <random>
 
-Npc::Npc(int x, int y, const std::string& type, const std::string& name)
-    : x_(x), y_(y), type_(type), name_(name), alive_(true) {}
+Npc::Npc(int x, int y, NpcType type, std::string_view name, std::pmr::memory_resource* resource)
+    : state_(x, y, true), type_(type), name_(name, resource) {}
+
+NpcState& Npc::state() {
+    return store_ ? store_->getState(slot_) : state_;
+}
+
+const NpcState& Npc::state() const {
+    return store_ ? store_->getState(slot_) : state_;
+}
 
 int Npc::getX() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return x_;
+    return state().getX();
 }
 
 int Npc::getY() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return y_;
+    return state().getY();
 }
 
-std::string Npc::getType() const {
-    return type_;
+const std::string& Npc::getType() const {
+    return npcTypeName(type_);
 }
 
 std::string Npc::getName() const {
-    return name_;
+    return std::string(name_);
 }
 
 void Npc::setX(int x) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    x_ = x;
+    setPosition(x, getY());
 }
 
 void Npc::setY(int y) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    y_ = y;
+    setPosition(getX(), y);
 }
 
 void Npc::setPosition(int x, int y) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    x_ = x;
-    y_ = y;
+    state().setPosition(x, y);
 }
 
 bool Npc::isAlive() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return alive_;
+    return state().isAlive();
 }
 
-void Npc::kill() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    alive_ = false;
+bool Npc::kill() {
+    return state().kill();
 }
 
 double Npc::distanceTo(const Npc& other) const {
-    std::lock_guard<std::mutex> lock1(mutex_);
-    std::lock_guard<std::mutex> lock2(other.mutex_);
-    
-    int dx = x_ - other.x_;
-    int dy = y_ - other.y_;
-    return std::sqrt(dx * dx + dy * dy);
+    // по одному атомарному чтению на NPC, без блокировок
+    NpcState::Value a = state().load();
+    NpcState::Value b = other.state().load();
+    // квадраты в int переполняются уже при разности около 46341
+    const int64_t dx = static_cast<int64_t>(a.x) - b.x;
+    const int64_t dy = static_cast<int64_t>(a.y) - b.y;
+    return std::sqrt(static_cast<double>(dx * dx + dy * dy));
 }
 
 void Npc::printInfo() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::cout << *this << std::endl;
 }
 
-std::ostream& operator<<(std::ostream& os, const Npc& npc) {
-    std::lock_guard<std::mutex> lock(npc.mutex_);
-    os << "NPC: " << npc.name_ << " (" << npc.type_ << ") at (" 
-       << npc.x_ << ", " << npc.y_ << ") - " 
-       << (npc.alive_ ? "Alive" : "Dead");
+std::ostream& writeNpcLine(std::ostream& os, std::string_view name, NpcType type, int x, int y, bool alive) {
+    os << "NPC: " << name << " (" << npcTypeName(type) << ") at (" 
+       << x << ", " << y << ") - " 
+       << (alive ? "Alive" : "Dead");
     return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const Npc& npc) {
+    NpcState::Value value = npc.state().load();
+    return writeNpcLine(os, npc.name_, npc.type_, value.x, value.y, value.alive);
 }
\ No newline at end of file
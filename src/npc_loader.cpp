@@ -0,0 +1,108 @@
+#include <charconv>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../include/npc_loader.h"
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// следующее слово строки; пустое, если слов больше нет
+std::string_view nextToken(std::string_view line, size_t& pos) {
+    while (pos < line.size() && isSpace(line[pos])) ++pos;
+    size_t start = pos;
+    while (pos < line.size() && !isSpace(line[pos])) ++pos;
+    return line.substr(start, pos - start);
+}
+
+bool parseInt(std::string_view token, int& value) {
+    const char* end = token.data() + token.size();
+    auto result = std::from_chars(token.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+// nullptr при успехе, иначе текст ошибки
+const char* parseLine(std::string_view line, NpcRecord& record) {
+    size_t pos = 0;
+    std::string_view type = nextToken(line, pos);
+    std::string_view name = nextToken(line, pos);
+    std::string_view x = nextToken(line, pos);
+    std::string_view y = nextToken(line, pos);
+
+    if (y.empty()) return "expected: type name x y";
+    if (!parseInt(x, record.x) || !parseInt(y, record.y)) return "coordinates are not integers";
+    if (record.x < 0 || record.y < 0) return "coordinates must be non-negative";
+
+    record.type = npcTypeFromString(type);
+    if (record.type == NpcType::Unknown) return "unknown NPC type";
+    record.name = name;
+    return nullptr;
+}
+
+}
+
+MappedFile::MappedFile(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file for reading: " + filename);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat file: " + filename);
+    }
+
+    size_ = static_cast<size_t>(info.st_size);
+    // пустой файл отобразить нельзя, но и читать в нём нечего
+    if (size_ > 0) {
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Failed to map file: " + filename);
+        }
+        ::madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(data);
+    }
+    // отображение остаётся действительным и после закрытия дескриптора
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+}
+
+size_t parseNpcRecords(std::string_view text, std::vector<NpcRecord>& records, std::vector<LoadError>& errors) {
+    // примерно 24 байта на строку в файлах saveToFile
+    records.reserve(records.size() + text.size() / 24);
+
+    size_t lines = 0;
+    size_t lineNumber = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) end = text.size();
+        std::string_view line = text.substr(pos, end - pos);
+        pos = end + 1;
+        ++lineNumber;
+
+        size_t first = 0;
+        while (first < line.size() && isSpace(line[first])) ++first;
+        if (first == line.size()) continue;
+        ++lines;
+
+        NpcRecord record;
+        record.line = lineNumber;
+        if (const char* error = parseLine(line, record)) {
+            errors.push_back({lineNumber, error});
+            continue;
+        }
+        records.push_back(record);
+    }
+    return lines;
+}
\ No newline at end of file
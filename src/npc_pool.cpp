@@ -0,0 +1,48 @@
+#include <new>
+#include "../include/npc_pool.h"
+#include "../include/dragon.h"
+#include "../include/elf.h"
+#include "../include/druid.h"
+
+NpcPool::NpcPool(size_t initialBytes, std::pmr::memory_resource* upstream)
+    : resource_(initialBytes, upstream), names_(&resource_) {}
+
+template <typename T>
+Npc* NpcPool::make(NpcType type, std::string_view name, int x, int y) {
+    auto& slots = free_[static_cast<size_t>(type)];
+    void* memory;
+    if (!slots.empty()) {
+        memory = slots.back();
+        slots.pop_back();
+        reused_++;
+    } else {
+        memory = resource_.allocate(sizeof(T), alignof(T));
+    }
+    live_++;
+    return new (memory) T(x, y, name, &names_);
+}
+
+Npc* NpcPool::create(NpcType type, std::string_view name, int x, int y) {
+    switch (type) {
+        case NpcType::Dragon: return make<Dragon>(type, name, x, y);
+        case NpcType::Elf: return make<Elf>(type, name, x, y);
+        case NpcType::Druid: return make<Druid>(type, name, x, y);
+        default: return nullptr;
+    }
+}
+
+void NpcPool::destroy(Npc* npc) {
+    const NpcType type = npc->getTypeId();
+    npc->~Npc();
+    // имя вернулось в пул блоков, место объекта - в список свободных
+    free_[static_cast<size_t>(type)].push_back(npc);
+    live_--;
+}
+
+void NpcPool::release() {
+    for (auto& slots : free_) slots.clear();
+    // пул блоков держит куски буфера, поэтому освобождается первым
+    names_.release();
+    resource_.release();
+    live_ = 0;
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include <functional>
+#include <stdexcept>
+#include "../include/npc_store.h"
+
+uint32_t NpcStore::hashName(std::string_view name) {
+    uint64_t hash = std::hash<std::string_view>{}(name);
+    // перемешивание: std::hash для строк может плохо заполнять младшие биты
+    return static_cast<uint32_t>((hash * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+size_t NpcStore::findPosition(std::string_view name, uint32_t hash) const {
+    if (index_.empty()) return SIZE_MAX;
+    for (size_t pos = hash & index_mask_;; pos = (pos + 1) & index_mask_) {
+        const IndexEntry& entry = index_[pos];
+        if (entry.slot == kNoSlot) return SIZE_MAX;
+        if (entry.hash == hash && names_[entry.slot] == name) return pos;
+    }
+}
+
+void NpcStore::growIndex(size_t count) {
+    // заполнение не больше половины
+    size_t capacity = 16;
+    while (capacity < count * 2) capacity <<= 1;
+    if (capacity <= index_.size()) return;
+
+    std::vector<IndexEntry> old(capacity, IndexEntry{kNoSlot, 0});
+    old.swap(index_);
+    index_mask_ = capacity - 1;
+    for (const IndexEntry& entry : old) {
+        if (entry.slot == kNoSlot) continue;
+        size_t pos = entry.hash & index_mask_;
+        while (index_[pos].slot != kNoSlot) pos = (pos + 1) & index_mask_;
+        index_[pos] = entry;
+    }
+}
+
+void NpcStore::reserve(size_t count) {
+    states_.reserve(count);
+    types_.reserve(count);
+    move_distances_.reserve(count);
+    kill_distances_.reserve(count);
+    generations_.reserve(count);
+    names_.reserve(count);
+    objects_.reserve(count);
+    pooled_.reserve(count);
+    growIndex(count);
+}
+
+NpcHandle NpcStore::insert(std::unique_ptr<Npc> npc) {
+    NpcHandle handle = tryInsert(std::move(npc));
+    if (!handle.isValid()) {
+        throw std::invalid_argument("NPC with this name already exists.");
+    }
+    return handle;
+}
+
+NpcStore::~NpcStore() {
+    clear();
+}
+
+NpcHandle NpcStore::tryInsert(std::unique_ptr<Npc> npc) {
+    const uint32_t hash = hashName(npc->name_);
+    if (findPosition(npc->name_, hash) != SIZE_MAX) return {};
+    return place(npc.release(), hash, false);
+}
+
+NpcHandle NpcStore::emplace(NpcType type, std::string_view name, int x, int y) {
+    // имя проверяется до создания, чтобы повтор не занимал место в пуле
+    const uint32_t hash = hashName(name);
+    if (findPosition(name, hash) != SIZE_MAX) return {};
+    Npc* npc = pool_.create(type, name, x, y);
+    if (!npc) return {};
+    return place(npc, hash, true);
+}
+
+NpcHandle NpcStore::place(Npc* npc, uint32_t hash, bool pooled) {
+    growIndex(size_ + 1);
+
+    uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = slotCount();
+        states_.emplace_back();
+        types_.emplace_back();
+        move_distances_.emplace_back();
+        kill_distances_.emplace_back();
+        // после clear() поколения слота продолжаются с прежнего значения
+        if (generations_.size() <= slot) generations_.emplace_back();
+        names_.emplace_back();
+        objects_.emplace_back();
+        pooled_.emplace_back();
+    }
+
+    NpcState::Value state = npc->state().load();
+    states_[slot].reset(state.x, state.y, state.alive);
+    types_[slot] = npc->getTypeId();
+    move_distances_[slot] = static_cast<uint16_t>(npc->getMoveDistance());
+    kill_distances_[slot] = static_cast<uint16_t>(npc->getKillDistance());
+    names_[slot] = npc->name_;
+    pooled_[slot] = pooled;
+    if (!pooled) heap_objects_++;
+
+    // с этого момента состояние NPC живёт в массивах хранилища
+    npc->store_ = this;
+    npc->slot_ = slot;
+    objects_[slot] = npc;
+
+    size_t pos = hash & index_mask_;
+    while (index_[pos].slot != kNoSlot) pos = (pos + 1) & index_mask_;
+    index_[pos] = {slot, hash};
+    size_++;
+    return {slot, generations_[slot]};
+}
+
+void NpcStore::erase(NpcHandle handle) {
+    if (!valid(handle)) return;
+
+    const uint32_t slot = handle.index;
+    size_t hole = findPosition(names_[slot], hashName(names_[slot]));
+    if (hole != SIZE_MAX) {
+        // запись сдвигается в дыру, если её домашняя позиция не между дырой и ней
+        for (size_t next = (hole + 1) & index_mask_; index_[next].slot != kNoSlot;
+             next = (next + 1) & index_mask_) {
+            size_t home = index_[next].hash & index_mask_;
+            if (((next - home) & index_mask_) >= ((next - hole) & index_mask_)) {
+                index_[hole] = index_[next];
+                hole = next;
+            }
+        }
+        index_[hole].slot = kNoSlot;
+    }
+    names_[slot] = {};
+    destroyObject(slot);
+    states_[slot].kill();
+    generations_[slot]++;
+    free_slots_.push_back(slot);
+    size_--;
+}
+
+void NpcStore::destroyObject(uint32_t slot) {
+    Npc* npc = objects_[slot];
+    objects_[slot] = nullptr;
+    if (pooled_[slot]) {
+        pool_.destroy(npc);
+    } else {
+        delete npc;
+        heap_objects_--;
+    }
+}
+
+void NpcStore::clear() {
+    // объекты пула не обходятся: пул отдаёт их память целиком
+    if (heap_objects_ != 0) {
+        for (uint32_t i = 0; i < slotCount(); ++i) {
+            if (objects_[i] && !pooled_[i]) delete objects_[i];
+        }
+        heap_objects_ = 0;
+    }
+    pool_.release();
+    states_.clear();
+    types_.clear();
+    move_distances_.clear();
+    kill_distances_.clear();
+    // поколения переживают очистку, иначе старые описатели стали бы
+    // указывать на новых NPC в тех же слотах
+    for (auto& generation : generations_) generation++;
+    names_.clear();
+    objects_.clear();
+    pooled_.clear();
+    index_.clear();
+    index_mask_ = 0;
+    free_slots_.clear();
+    size_ = 0;
+}
+
+bool NpcStore::valid(NpcHandle handle) const {
+    return handle.index < slotCount() &&
+           generations_[handle.index] == handle.generation &&
+           objects_[handle.index] != nullptr;
+}
+
+NpcHandle NpcStore::find(std::string_view name) const {
+    size_t pos = findPosition(name, hashName(name));
+    if (pos == SIZE_MAX) return {};
+    return handleAt(index_[pos].slot);
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#include "../include/npc_type.h"
+
+namespace {
+
+const std::string kTypeNames[] = {"Dragon", "Elf", "Druid", "Unknown"};
+const char kTypeSymbols[] = {'D', 'E', 'R', '?'};
+
+size_t indexOf(NpcType type) {
+    auto index = static_cast<size_t>(type);
+    return index < kNpcTypeCount ? index : kNpcTypeCount;
+}
+
+}
+
+NpcType npcTypeFromString(std::string_view type) {
+    for (size_t id = 0; id < kNpcTypeCount; ++id) {
+        if (kTypeNames[id] == type) return static_cast<NpcType>(id);
+    }
+    return NpcType::Unknown;
+}
+
+const std::string& npcTypeName(NpcType type) {
+    return kTypeNames[indexOf(type)];
+}
+
+char npcTypeSymbol(NpcType type) {
+    return kTypeSymbols[indexOf(type)];
+}
\ No newline at end of file
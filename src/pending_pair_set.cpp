@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <vector>
+#include "../include/pending_pair_set.h"
+
+PendingPairSet::PendingPairSet(size_t capacity)
+    : capacity_([capacity] {
+          size_t result = 16;
+          while (result < capacity) result <<= 1;
+          return result;
+      }()),
+      mask_(capacity_ - 1),
+      slots_(new std::atomic<uint64_t>[capacity_]),
+      size_(0), tombstones_(0), moves_(0), next_compaction_(capacity_ / 4) {
+    for (size_t i = 0; i < capacity_; ++i) {
+        slots_[i].store(kEmpty, std::memory_order_relaxed);
+    }
+}
+
+uint64_t PendingPairSet::pairKey(uint32_t first, uint32_t second) {
+    uint32_t low = std::min(first, second);
+    uint32_t high = std::max(first, second);
+    return (static_cast<uint64_t>(low) << 32) | high;
+}
+
+size_t PendingPairSet::home(uint64_t key) const {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask_;
+}
+
+PendingPairSet::InsertResult PendingPairSet::insert(uint64_t key) {
+    if (tombstones_.load(std::memory_order_relaxed) > next_compaction_) {
+        compact();
+    }
+
+    const uint64_t stored = encode(key);
+    size_t firstFree = capacity_;
+    size_t pos = home(key);
+
+    size_t probe = 0;
+    for (; probe < capacity_; ++probe, pos = (pos + 1) & mask_) {
+        uint64_t value = slots_[pos].load(std::memory_order_acquire);
+        if (value == stored) return InsertResult::Duplicate;
+        if (value == kTombstone) {
+            if (firstFree == capacity_) firstFree = pos;
+            continue;
+        }
+        if (value == kEmpty) break;
+    }
+
+    if (probe < capacity_) {
+        // надгробия перед пустым слотом никому не нужны: за ними нет ключей,
+        // и цепочка пробирования теперь заканчивается раньше
+        // (только в пределах пути от домашнего слота этого ключа)
+        size_t chainEnd = pos;
+        for (size_t step = 0; step < probe; ++step) {
+            size_t back = (chainEnd + capacity_ - 1) & mask_;
+            uint64_t expected = kTombstone;
+            if (!slots_[back].compare_exchange_strong(expected, kEmpty)) break;
+            tombstones_.fetch_sub(1, std::memory_order_relaxed);
+            chainEnd = back;
+        }
+        if (firstFree == capacity_ || slots_[firstFree].load(std::memory_order_relaxed) == kEmpty) {
+            firstFree = chainEnd;
+        }
+    }
+
+    // все слоты заняты ключами
+    if (firstFree == capacity_) return InsertResult::Full;
+
+    // вставляет только этот поток, поэтому свободный слот занять некому,
+    // а удаляющие потоки надгробия и пустые слоты не трогают
+    if (slots_[firstFree].load(std::memory_order_relaxed) == kTombstone) {
+        tombstones_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    slots_[firstFree].store(stored, std::memory_order_release);
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return InsertResult::Inserted;
+}
+
+void PendingPairSet::erase(uint64_t key) {
+    const uint64_t stored = encode(key);
+    for (;;) {
+        const uint64_t moves = moves_.load();
+        size_t pos = home(key);
+        for (size_t probe = 0; probe < capacity_; ++probe, pos = (pos + 1) & mask_) {
+            uint64_t value = slots_[pos].load(std::memory_order_acquire);
+            if (value == kEmpty) break;
+            if (value == stored) {
+                // счётчик растёт раньше, чтобы занявший надгробие не увёл его в минус
+                tombstones_.fetch_add(1, std::memory_order_relaxed);
+                if (slots_[pos].compare_exchange_strong(value, kTombstone)) {
+                    size_.fetch_sub(1, std::memory_order_relaxed);
+                    return;
+                }
+                // ключ как раз переносят на другое место
+                tombstones_.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+        }
+        if (!movedSince(moves)) return;
+    }
+}
+
+bool PendingPairSet::contains(uint64_t key) const {
+    const uint64_t stored = encode(key);
+    for (;;) {
+        const uint64_t moves = moves_.load();
+        size_t pos = home(key);
+        for (size_t probe = 0; probe < capacity_; ++probe, pos = (pos + 1) & mask_) {
+            uint64_t value = slots_[pos].load(std::memory_order_acquire);
+            if (value == kEmpty) break;
+            if (value == stored) return true;
+        }
+        if (!movedSince(moves)) return false;
+    }
+}
+
+bool PendingPairSet::movedSince(uint64_t moves) const {
+    // загрузки слотов не должны переехать за повторное чтение счётчика
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return moves % 2 != 0 || moves_.load() != moves;
+}
+
+void PendingPairSet::compact() {
+    // обход от пустого слота: цепочки через него не проходят, и каждый ключ
+    // переносится на первое надгробие своего пути
+    size_t start = 0;
+    while (start < capacity_ && slots_[start].load(std::memory_order_acquire) != kEmpty) ++start;
+    if (start == capacity_) start = 0;
+
+    for (size_t i = 1; i <= capacity_; ++i) {
+        const size_t pos = (start + i) & mask_;
+        const uint64_t value = slots_[pos].load(std::memory_order_acquire);
+        if (value == kEmpty || value == kTombstone) continue;
+
+        // первое надгробие на пути от домашнего слота ключа до его места
+        size_t target = home(value - 2);
+        while (target != pos && slots_[target].load(std::memory_order_acquire) != kTombstone) {
+            target = (target + 1) & mask_;
+        }
+        if (target == pos) continue;
+
+        // на время переноса ключ лежит в обоих слотах
+        moves_.fetch_add(1);
+        slots_[target].store(value, std::memory_order_release);
+        uint64_t expected = value;
+        if (!slots_[pos].compare_exchange_strong(expected, kTombstone)) {
+            // ключ удалили на старом месте - копия тоже не нужна
+            expected = value;
+            if (!slots_[target].compare_exchange_strong(expected, kTombstone)) {
+                tombstones_.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+        moves_.fetch_add(1);
+    }
+
+    // надгробие можно сделать пустым слотом, если через него не идёт путь
+    // ни к одному ключу; удаления путей только укорачивают
+    std::vector<bool> onPath(capacity_, false);
+    for (size_t pos = 0; pos < capacity_; ++pos) {
+        const uint64_t value = slots_[pos].load(std::memory_order_acquire);
+        if (value == kEmpty || value == kTombstone) continue;
+        for (size_t slot = home(value - 2); slot != pos; slot = (slot + 1) & mask_) {
+            onPath[slot] = true;
+        }
+    }
+    for (size_t pos = 0; pos < capacity_; ++pos) {
+        uint64_t expected = kTombstone;
+        if (!onPath[pos] && slots_[pos].compare_exchange_strong(expected, kEmpty)) {
+            tombstones_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    next_compaction_ = std::max(capacity_ / 4, tombstones() + capacity_ / 8);
+}
\ No newline at end of file
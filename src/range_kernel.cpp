@@ -0,0 +1,180 @@
+#include <cmath>
+#include <limits>
+#include "../include/range_kernel.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define LAB7_RANGE_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+uint64_t scalarMask(const RangeQuery& query, const RangeBlock& block) {
+    uint64_t mask = 0;
+    for (size_t j = 0; j < block.count; ++j) {
+        const int64_t dx = static_cast<int64_t>(block.x[j]) - query.x;
+        const int64_t dy = static_cast<int64_t>(block.y[j]) - query.y;
+        const bool hit = dx * dx + dy * dy <= query.range_sq && (query.hostile >> block.types[j] & 1u);
+        mask |= static_cast<uint64_t>(hit) << j;
+    }
+    return mask;
+}
+
+#ifdef LAB7_RANGE_KERNEL_X86
+
+// Разности по модулю обрезаются до kVectorRangeLimit: сумма квадратов тогда
+// помещается в int32, а обрезанная разность всё равно больше радиуса.
+// Враждебность - таблица из 16 байт по типу через pshufb; старшие байты
+// индекса с установленным старшим битом дают ноль. Сравнения знаковые, поэтому
+// dist <= range_sq проверяется как range_sq + 1 > dist.
+
+__attribute__((target("sse4.1")))
+uint64_t sse41Mask(const RangeQuery& query, const RangeBlock& block) {
+    const __m128i qx = _mm_set1_epi32(query.x);
+    const __m128i qy = _mm_set1_epi32(query.y);
+    const __m128i limit = _mm_set1_epi32(static_cast<int32_t>(kVectorRangeLimit));
+    const __m128i range = _mm_set1_epi32(static_cast<int32_t>(query.range_sq + 1));
+    const __m128i high = _mm_set1_epi32(static_cast<int32_t>(0xFFFFFF00u));
+    alignas(16) uint8_t table[16] = {};
+    for (int t = 0; t < 8; ++t) table[t] = (query.hostile >> t & 1u) ? 0xFF : 0;
+    const __m128i hostile = _mm_load_si128(reinterpret_cast<const __m128i*>(table));
+
+    uint64_t mask = 0;
+    size_t j = 0;
+    for (; j + 4 <= block.count; j += 4) {
+        __m128i dx = _mm_abs_epi32(_mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block.x + j)), qx));
+        __m128i dy = _mm_abs_epi32(_mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block.y + j)), qy));
+        dx = _mm_min_epu32(dx, limit);
+        dy = _mm_min_epu32(dy, limit);
+        __m128i dist = _mm_add_epi32(_mm_mullo_epi32(dx, dx), _mm_mullo_epi32(dy, dy));
+        __m128i near = _mm_cmpgt_epi32(range, dist);
+
+        int32_t types;
+        __builtin_memcpy(&types, block.types + j, sizeof(types));
+        __m128i index = _mm_or_si128(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(types)), high);
+        __m128i enemy = _mm_shuffle_epi8(hostile, index);
+        __m128i hit = _mm_andnot_si128(_mm_cmpeq_epi32(enemy, _mm_setzero_si128()), near);
+        mask |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(hit))) << j;
+    }
+    if (j < block.count) {
+        mask |= scalarMask(query, {block.x + j, block.y + j, block.types + j, block.count - j}) << j;
+    }
+    return mask;
+}
+
+__attribute__((target("avx2")))
+uint64_t avx2Mask(const RangeQuery& query, const RangeBlock& block) {
+    const __m256i qx = _mm256_set1_epi32(query.x);
+    const __m256i qy = _mm256_set1_epi32(query.y);
+    const __m256i limit = _mm256_set1_epi32(static_cast<int32_t>(kVectorRangeLimit));
+    const __m256i range = _mm256_set1_epi32(static_cast<int32_t>(query.range_sq + 1));
+    const __m256i high = _mm256_set1_epi32(static_cast<int32_t>(0xFFFFFF00u));
+    alignas(16) uint8_t table[16] = {};
+    for (int t = 0; t < 8; ++t) table[t] = (query.hostile >> t & 1u) ? 0xFF : 0;
+    // pshufb работает в каждой 128-битной половине отдельно: таблица в обеих
+    const __m256i hostile = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table)));
+
+    uint64_t mask = 0;
+    size_t j = 0;
+    for (; j + 8 <= block.count; j += 8) {
+        __m256i dx = _mm256_abs_epi32(
+            _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block.x + j)), qx));
+        __m256i dy = _mm256_abs_epi32(
+            _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block.y + j)), qy));
+        dx = _mm256_min_epu32(dx, limit);
+        dy = _mm256_min_epu32(dy, limit);
+        __m256i dist = _mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dy, dy));
+        __m256i near = _mm256_cmpgt_epi32(range, dist);
+
+        __m256i index = _mm256_or_si256(
+            _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(block.types + j))), high);
+        __m256i enemy = _mm256_shuffle_epi8(hostile, index);
+        __m256i hit = _mm256_andnot_si256(_mm256_cmpeq_epi32(enemy, _mm256_setzero_si256()), near);
+        mask |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(hit))) << j;
+    }
+    if (j < block.count) {
+        // хвост меньше 8 - на SSE4.1, он есть везде, где есть AVX2
+        mask |= sse41Mask(query, {block.x + j, block.y + j, block.types + j, block.count - j}) << j;
+    }
+    return mask;
+}
+
+#endif
+
+using MaskFunction = uint64_t (*)(const RangeQuery&, const RangeBlock&);
+
+RangeKernel detectKernel() {
+#ifdef LAB7_RANGE_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return RangeKernel::AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return RangeKernel::SSE41;
+#endif
+    return RangeKernel::Scalar;
+}
+
+MaskFunction functionFor(RangeKernel kernel) {
+#ifdef LAB7_RANGE_KERNEL_X86
+    if (!rangeKernelSupported(kernel)) return scalarMask;
+    switch (kernel) {
+        case RangeKernel::AVX2: return avx2Mask;
+        case RangeKernel::SSE41: return sse41Mask;
+        default: break;
+    }
+#else
+    (void)kernel;
+#endif
+    return scalarMask;
+}
+
+// выбирается один раз; статическая инициализация в функции потокобезопасна
+MaskFunction activeFunction() {
+    static const MaskFunction function = functionFor(activeRangeKernel());
+    return function;
+}
+
+bool fitsVector(const RangeQuery& query) {
+    return query.range_sq >= 0 && query.range_sq < kVectorRangeLimit * kVectorRangeLimit;
+}
+
+}
+
+uint64_t rangeMask(const RangeQuery& query, const RangeBlock& block) {
+    return fitsVector(query) ? activeFunction()(query, block) : scalarMask(query, block);
+}
+
+uint64_t rangeMask(RangeKernel kernel, const RangeQuery& query, const RangeBlock& block) {
+    return fitsVector(query) ? functionFor(kernel)(query, block) : scalarMask(query, block);
+}
+
+RangeKernel activeRangeKernel() {
+    static const RangeKernel kernel = detectKernel();
+    return kernel;
+}
+
+bool rangeKernelSupported(RangeKernel kernel) {
+    switch (kernel) {
+        case RangeKernel::Scalar: return true;
+        case RangeKernel::SSE41: return activeRangeKernel() != RangeKernel::Scalar;
+        case RangeKernel::AVX2: return activeRangeKernel() == RangeKernel::AVX2;
+    }
+    return false;
+}
+
+const char* rangeKernelName(RangeKernel kernel) {
+    switch (kernel) {
+        case RangeKernel::Scalar: return "scalar";
+        case RangeKernel::SSE41: return "sse4.1";
+        case RangeKernel::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+int64_t squaredRange(double range) {
+    if (!(range >= 0)) return -1;
+    if (range >= 3037000499.0) return std::numeric_limits<int64_t>::max();
+    auto r = static_cast<int64_t>(std::floor(range * range));
+    // поправка на округление range * range
+    while (r > 0 && std::sqrt(static_cast<double>(r)) > range) --r;
+    while (std::sqrt(static_cast<double>(r + 1)) <= range) ++r;
+    return r;
+}
\ No newline at end of file
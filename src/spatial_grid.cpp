@@ -0,0 +1,58 @@
+#include <algorithm>
+#include "../include/spatial_grid.h"
+
+int SpatialGrid::cellCoord(int value) const {
+    // деление с округлением вниз, чтобы отрицательные координаты не сливались с нулевой ячейкой
+    return value >= 0 ? value / cell_size_ : -((-(value + 1)) / cell_size_) - 1;
+}
+
+uint32_t SpatialGrid::findOrInsert(int cx, int cy) {
+    for (size_t pos = hashCell(cx, cy) & mask_;; pos = (pos + 1) & mask_) {
+        uint32_t index = table_[pos];
+        if (index == kNoCell) {
+            index = static_cast<uint32_t>(cells_.size());
+            cells_.push_back({cx, cy, 0, 0});
+            table_[pos] = index;
+            return index;
+        }
+        if (cells_[index].cx == cx && cells_[index].cy == cy) return index;
+    }
+}
+
+void SpatialGrid::rebuild(int cellSize, const std::vector<Entry>& entries) {
+    cell_size_ = std::max(cellSize, 1);
+
+    // занятых ячеек не больше, чем NPC; таблица заполнена не более чем наполовину
+    size_t capacity = 16;
+    while (capacity < entries.size() * 2) capacity <<= 1;
+    table_.assign(capacity, kNoCell);
+    mask_ = capacity - 1;
+    cells_.clear();
+
+    // первый проход: ячейка каждого NPC и число NPC в ячейке (пока в end)
+    entry_cells_.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        uint32_t cell = findOrInsert(cellCoord(entries[i].x), cellCoord(entries[i].y));
+        entry_cells_[i] = cell;
+        cells_[cell].end++;
+    }
+
+    uint32_t offset = 0;
+    for (Cell& cell : cells_) {
+        uint32_t count = cell.end;
+        cell.begin = offset;
+        cell.end = offset;
+        offset += count;
+    }
+
+    // второй проход: раскладка по ячейкам, end служит курсором
+    sorted_.resize(entries.size());
+    sorted_x_.resize(entries.size());
+    sorted_y_.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        uint32_t position = cells_[entry_cells_[i]].end++;
+        sorted_[position] = entries[i];
+        sorted_x_[position] = entries[i].x;
+        sorted_y_[position] = entries[i].y;
+    }
+}
\ No newline at end of file
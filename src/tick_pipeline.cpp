@@ -0,0 +1,118 @@
+#include <algorithm>
+#include "../include/tick_pipeline.h"
+
+namespace {
+
+std::chrono::microseconds elapsed(std::chrono::steady_clock::time_point from,
+                                  std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from);
+}
+
+}
+
+void StageLatency::add(std::chrono::microseconds duration) {
+    count++;
+    last = duration;
+    max = std::max(max, duration);
+    total += duration;
+}
+
+std::chrono::microseconds StageLatency::mean() const {
+    return count == 0 ? std::chrono::microseconds{0} : total / static_cast<int64_t>(count);
+}
+
+TickPipeline::TickPipeline(Stages stages, std::chrono::milliseconds interval)
+    : stages_(std::move(stages)), interval_(interval) {}
+
+TickPipeline::~TickPipeline() {
+    stop();
+}
+
+void TickPipeline::start() {
+    if (move_thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = true;
+        moving_ = true;
+    }
+    combat_thread_ = std::thread(&TickPipeline::combatThreadFunc, this);
+    move_thread_ = std::thread(&TickPipeline::moveThreadFunc, this);
+}
+
+void TickPipeline::stop() {
+    if (!move_thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    move_thread_.join();
+    combat_thread_.join();
+}
+
+PipelineStats TickPipeline::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void TickPipeline::moveThreadFunc() {
+    auto next = Clock::now() + interval_;
+    for (uint64_t tick = 1;; ++tick) {
+        bool overlapped;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_until(lock, next, [this] { return !running_; });
+            // буфер tick & 1 свободен, когда завершён тик tick - 2
+            cv_.wait(lock, [this, tick] { return !running_ || completed_ + 2 >= tick; });
+            if (!running_) break;
+            overlapped = completed_ + 1 < tick;
+        }
+
+        const auto start = Clock::now();
+        stages_.move(tick);
+        const auto end = Clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            started_[tick & 1] = start;
+            moved_ = tick;
+            stats_.move.add(elapsed(start, end));
+            if (overlapped) stats_.overlapped++;
+        }
+        cv_.notify_all();
+        next = std::max(next + interval_, end);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        moving_ = false;
+    }
+    cv_.notify_all();
+}
+
+void TickPipeline::combatThreadFunc() {
+    for (uint64_t tick = 1;; ++tick) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this, tick] { return !moving_ || moved_ >= tick; });
+            // после stop() доводятся тики, успевшие пройти движение
+            if (moved_ < tick) break;
+        }
+
+        const auto start = Clock::now();
+        stages_.combat(tick);
+        const auto fought = Clock::now();
+        stages_.publish(tick);
+        const auto end = Clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            completed_ = tick;
+            stats_.ticks++;
+            stats_.combat.add(elapsed(start, fought));
+            stats_.publish.add(elapsed(fought, end));
+            stats_.end_to_end.add(elapsed(started_[tick & 1], end));
+        }
+        cv_.notify_all();
+    }
+}
\ No newline at end of file
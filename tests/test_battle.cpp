@@ -1,4 +1,8 @@
 #include <gtest/gtest.h>
+#include <cmath>
+#include <set>
+#include <sstream>
+#include <tuple>
 #include "../include/arena.h"
 #include "../include/factory.h"
 #include "../include/combat_visitor.h"
@@ -119,6 +123,13 @@ TEST(AsyncBattleTest, DruidMoveDistance) {
     EXPECT_EQ(druid.getMoveDistance(), 10);
 }
 
+TEST(AsyncBattleTest, DistanceToFarNpcDoesNotOverflow) {
+    Dragon dragon(0, 0, "Dragon");
+    Elf elf(60000, 80000, "Elf");
+    EXPECT_DOUBLE_EQ(dragon.distanceTo(elf), 100000.0);
+    EXPECT_DOUBLE_EQ(elf.distanceTo(dragon), 100000.0);
+}
+
 TEST(AsyncBattleTest, BattleRulesComplete) {
     CombatVisitor visitor;
     
@@ -136,6 +147,18 @@ TEST(AsyncBattleTest, BattleRulesComplete) {
     EXPECT_FALSE(visitor.canKill(&druid, &elf));
 }
 
+TEST(AsyncBattleTest, SurvivorsUseNpcOutputFormat) {
+    Arena arena(100, 100);
+    arena.createAndAddNpc("Elf", "Elf1", 12, 34);
+    std::ostringstream expected;
+    expected << *arena.getAliveNpcs().front();
+    EXPECT_EQ(expected.str(), "NPC: Elf1 (Elf) at (12, 34) - Alive");
+
+    testing::internal::CaptureStdout();
+    arena.printSurvivors();
+    EXPECT_NE(testing::internal::GetCapturedStdout().find(expected.str() + "\n"), std::string::npos);
+}
+
 TEST(AsyncBattleTest, ArenaBattleShortGame) {
     Arena arena(100, 100);
     
@@ -160,4 +183,123 @@ TEST(AsyncBattleTest, ArenaBattleDruidVsDragon) {
     arena.startGame(2);
     
     EXPECT_LE(arena.getAliveCount(), 1);
+}
+
+namespace {
+
+class BattleRecorder : public Observer {
+    public:
+        void notify(const std::string& event) override {
+            texts.push_back(event);
+        }
+        void onBattle(const BattleEvent& event, const BattleEventContext& context) override {
+            events.push_back(event);
+            texts.push_back(formatBattleEvent(event, context));
+        }
+
+        std::vector<BattleEvent> events;
+        std::vector<std::string> texts;
+};
+
+}
+
+TEST(AsyncBattleTest, StartBattleReportsStructuredEvent) {
+    Arena arena(100, 100);
+    auto recorder = std::make_shared<BattleRecorder>();
+    arena.addObserver(recorder);
+
+    arena.createAndAddNpc("Elf", "Elf1", 10, 10);
+    arena.createAndAddNpc("Dragon", "Dragon1", 12, 10);
+    arena.startBattle(5.0);
+
+    ASSERT_EQ(recorder->events.size(), 1u);
+    const BattleEvent& event = recorder->events[0];
+    EXPECT_EQ(event.outcome, BattleOutcome::DefenderWon);
+    EXPECT_EQ(event.attacker_type, NpcType::Elf);
+    EXPECT_EQ(event.defender_type, NpcType::Dragon);
+    EXPECT_EQ(event.attacker_attack, 0);
+    EXPECT_EQ(recorder->texts[0], "Dragon1 (Dragon) killed Elf1 (Elf)");
+    EXPECT_EQ(arena.getNpcCount(), 1u);
+}
+
+TEST(AsyncBattleTest, StartBattleMatchesPairwiseReference) {
+    const double range = 10.0;
+    for (size_t threads : {1u, 4u}) {
+        Arena arena(2000, 2000);
+        arena.setSeed(11);
+        arena.setWorkerThreads(threads);
+        arena.generateRandomNpcs(5000, false);
+
+        // полный перебор пар по снимку до битвы
+        std::vector<std::tuple<uint32_t, uint32_t, BattleOutcome>> expected;
+        std::set<uint32_t> dead;
+        {
+            auto world = arena.snapshot();
+            const auto& npcs = world->npcs;
+            for (size_t i = 0; i < npcs.size(); ++i) {
+                for (size_t j = i + 1; j < npcs.size(); ++j) {
+                    double dx = npcs[i].x - npcs[j].x;
+                    double dy = npcs[i].y - npcs[j].y;
+                    if (std::sqrt(dx * dx + dy * dy) > range) continue;
+                    bool first = canKill(npcs[i].type, npcs[j].type);
+                    bool second = canKill(npcs[j].type, npcs[i].type);
+                    if (!first && !second) continue;
+                    BattleOutcome outcome = first && second ? BattleOutcome::BothDied
+                                          : first ? BattleOutcome::AttackerWon
+                                                  : BattleOutcome::DefenderWon;
+                    expected.emplace_back(npcs[i].handle.index, npcs[j].handle.index, outcome);
+                    if (first) dead.insert(npcs[j].handle.index);
+                    if (second) dead.insert(npcs[i].handle.index);
+                }
+            }
+        }
+        ASSERT_FALSE(expected.empty());
+
+        auto recorder = std::make_shared<BattleRecorder>();
+        arena.addObserver(recorder);
+        arena.startBattle(range);
+
+        std::vector<std::tuple<uint32_t, uint32_t, BattleOutcome>> actual;
+        for (const auto& event : recorder->events) {
+            actual.emplace_back(event.attacker.index, event.defender.index, event.outcome);
+        }
+        EXPECT_EQ(actual, expected) << "threads: " << threads;
+        EXPECT_EQ(arena.getNpcCount(), 5000u - dead.size());
+    }
+}
+
+TEST(AsyncBattleTest, DiceEventFormatsLikeTextMessages) {
+    class Names : public BattleEventContext {
+        public:
+            std::string_view nameOf(NpcHandle npc) const override {
+                return npc.index == 0 ? "A" : "B";
+            }
+    } names;
+
+    BattleEvent event;
+    event.attacker = {0, 0};
+    event.defender = {1, 0};
+    event.attacker_type = NpcType::Druid;
+    event.defender_type = NpcType::Dragon;
+    event.attacker_attack = 6;
+    event.attacker_defense = 2;
+    event.defender_attack = 5;
+    event.defender_defense = 1;
+
+    event.outcome = BattleOutcome::BothDied;
+    EXPECT_EQ(formatBattleEvent(event, names), "A (Druid) and B (Dragon) killed each other [6 vs 1, 5 vs 2]");
+    event.outcome = BattleOutcome::AttackerWon;
+    EXPECT_EQ(formatBattleEvent(event, names), "A (Druid) killed B (Dragon) [6 > 1]");
+    event.outcome = BattleOutcome::DefenderWon;
+    EXPECT_EQ(formatBattleEvent(event, names), "B (Dragon) killed A (Druid) [5 > 2]");
+}
+
+TEST(AsyncBattleTest, KillMatrixIsCompileTime) {
+    static_assert(canKill(NpcType::Dragon, NpcType::Elf), "dragon kills elves");
+    static_assert(!canKill(NpcType::Elf, NpcType::Dragon), "elves do not kill dragons");
+    EXPECT_FALSE(canKill(NpcType::Unknown, NpcType::Elf));
+    EXPECT_FALSE(canKill(NpcType::Druid, NpcType::Unknown));
+    EXPECT_EQ(npcTypeFromString("Druid"), NpcType::Druid);
+    EXPECT_EQ(npcTypeFromString("Goblin"), NpcType::Unknown);
+    EXPECT_EQ(npcTypeSymbol(NpcType::Druid), 'R');
 }
\ No newline at end of file
@@ -0,0 +1,1157 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <utility>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "../include/spatial_grid.h"
+#include "../include/range_kernel.h"
+#include "../include/npc_store.h"
+#include "../include/npc_state.h"
+#include "../include/ring_buffer.h"
+#include "../include/battle_queue.h"
+#include "../include/pending_pair_set.h"
+#include "../include/factory.h"
+#include "../include/file_observer.h"
+#include "../include/map_renderer.h"
+#include "../include/snapshot_publisher.h"
+#include "../include/arena.h"
+#include "../include/npc_loader.h"
+#include "../include/binary_snapshot.h"
+#include "../include/checkpointer.h"
+#include "../include/metrics.h"
+#include <filesystem>
+#include <map>
+#include <memory_resource>
+#include <tuple>
+
+namespace {
+
+std::set<std::pair<uint32_t, uint32_t>> pairsWithin(const std::vector<SpatialGrid::Entry>& entries, int radius) {
+    std::set<std::pair<uint32_t, uint32_t>> result;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        for (size_t j = i + 1; j < entries.size(); ++j) {
+            int dx = entries[i].x - entries[j].x;
+            int dy = entries[i].y - entries[j].y;
+            if (dx * dx + dy * dy <= radius * radius) {
+                result.insert({entries[i].id, entries[j].id});
+            }
+        }
+    }
+    return result;
+}
+
+}
+
+TEST(SpatialGridTest, FindsSamePairsAsBruteForce) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> coord(0, 500);
+    std::vector<SpatialGrid::Entry> entries;
+    for (uint32_t i = 0; i < 300; ++i) {
+        entries.push_back({coord(gen), coord(gen), i});
+    }
+
+    SpatialGrid grid;
+    grid.rebuild(30, entries);
+
+    std::set<std::pair<uint32_t, uint32_t>> found;
+    grid.forEachCandidatePair([&](const SpatialGrid::Entry& a, const SpatialGrid::Entry& b) {
+        int dx = a.x - b.x;
+        int dy = a.y - b.y;
+        if (dx * dx + dy * dy <= 30 * 30) {
+            found.insert({std::min(a.id, b.id), std::max(a.id, b.id)});
+        }
+    });
+
+    EXPECT_EQ(found, pairsWithin(entries, 30));
+}
+
+TEST(SpatialGridTest, BlocksVisitPairsInPairOrder) {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<> coord(0, 300);
+    std::vector<SpatialGrid::Entry> entries;
+    for (uint32_t i = 0; i < 400; ++i) {
+        entries.push_back({coord(gen), coord(gen), i});
+    }
+    SpatialGrid grid;
+    grid.rebuild(25, entries);
+
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    grid.forEachCandidatePair([&](const SpatialGrid::Entry& a, const SpatialGrid::Entry& b) {
+        pairs.emplace_back(a.id, b.id);
+    });
+    std::vector<std::pair<uint32_t, uint32_t>> blocks;
+    const auto& sorted = grid.getSorted();
+    grid.forEachCandidateBlock(0, grid.getCellCount(), [&](uint32_t k, uint32_t first, uint32_t last) {
+        EXPECT_EQ(grid.getSortedX()[k], sorted[k].x);
+        for (uint32_t j = first; j < last; ++j) blocks.emplace_back(sorted[k].id, sorted[j].id);
+    });
+    EXPECT_EQ(blocks, pairs);
+}
+
+TEST(SpatialGridTest, EachPairVisitedOnce) {
+    std::vector<SpatialGrid::Entry> entries = {{0, 0, 0}, {5, 5, 1}, {10, 10, 2}, {100, 100, 3}};
+
+    SpatialGrid grid;
+    grid.rebuild(50, entries);
+
+    std::multiset<std::pair<uint32_t, uint32_t>> visited;
+    grid.forEachCandidatePair([&](const SpatialGrid::Entry& a, const SpatialGrid::Entry& b) {
+        visited.insert({std::min(a.id, b.id), std::max(a.id, b.id)});
+    });
+
+    for (const auto& pair : visited) {
+        EXPECT_EQ(visited.count(pair), 1u);
+    }
+    EXPECT_EQ(visited.count({0, 1}), 1u);
+    EXPECT_EQ(visited.count({0, 2}), 1u);
+    EXPECT_EQ(visited.count({1, 2}), 1u);
+}
+
+TEST(SpatialGridTest, EmptyGrid) {
+    SpatialGrid grid;
+    grid.rebuild(10, {});
+
+    int calls = 0;
+    grid.forEachCandidatePair([&](const SpatialGrid::Entry&, const SpatialGrid::Entry&) { calls++; });
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(grid.getCellCount(), 0u);
+}
+
+TEST(SpatialGridTest, SparseWorldAllocatesOnlyOccupiedCells) {
+    std::vector<SpatialGrid::Entry> entries = {
+        {0, 0, 0}, {5, 5, 1}, {99999990, 99999990, 2}, {99999995, 99999999, 3}};
+
+    SpatialGrid grid;
+    grid.rebuild(10, entries);
+    EXPECT_EQ(grid.getCellCount(), 2u);
+
+    std::set<std::pair<uint32_t, uint32_t>> visited;
+    grid.forEachCandidatePair([&](const SpatialGrid::Entry& a, const SpatialGrid::Entry& b) {
+        visited.insert({std::min(a.id, b.id), std::max(a.id, b.id)});
+    });
+    std::set<std::pair<uint32_t, uint32_t>> expected = {{0, 1}, {2, 3}};
+    EXPECT_EQ(visited, expected);
+}
+
+TEST(RangeKernelTest, EveryKernelMatchesScalarReference) {
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int32_t> coord(0, 400);
+    std::uniform_int_distribution<int> type(0, 3);
+    std::vector<int32_t> xs(kRangeBlockSize);
+    std::vector<int32_t> ys(kRangeBlockSize);
+    std::vector<uint8_t> types(kRangeBlockSize);
+
+    for (int round = 0; round < 200; ++round) {
+        for (size_t j = 0; j < kRangeBlockSize; ++j) {
+            xs[j] = coord(gen);
+            ys[j] = coord(gen);
+            types[j] = static_cast<uint8_t>(type(gen));
+        }
+        const size_t count = 1 + round % kRangeBlockSize;
+        // радиус до 300, последние раунды - больше векторного предела
+        const int64_t range = round < 190 ? round * 3 / 2 : kVectorRangeLimit + round;
+        const RangeQuery query{coord(gen), coord(gen), range * range,
+                               hostileTypes(static_cast<NpcType>(round % kNpcTypeCount))};
+
+        uint64_t expected = 0;
+        for (size_t j = 0; j < count; ++j) {
+            int64_t dx = xs[j] - query.x;
+            int64_t dy = ys[j] - query.y;
+            if (dx * dx + dy * dy <= query.range_sq && (query.hostile >> types[j] & 1u)) expected |= 1ull << j;
+        }
+        const RangeBlock block{xs.data(), ys.data(), types.data(), count};
+        for (RangeKernel kernel : {RangeKernel::Scalar, RangeKernel::SSE41, RangeKernel::AVX2}) {
+            EXPECT_EQ(rangeMask(kernel, query, block), expected) << rangeKernelName(kernel) << " round " << round;
+        }
+        EXPECT_EQ(rangeMask(query, block), expected);
+    }
+}
+
+TEST(RangeKernelTest, FarCoordinatesDoNotWrapIntoRange) {
+    // разность 2^30 переполнила бы квадрат в 32 битах
+    std::vector<int32_t> xs(8, 1 << 30);
+    std::vector<int32_t> ys(8, 0);
+    std::vector<uint8_t> types(8, static_cast<uint8_t>(NpcType::Elf));
+    xs[5] = 3;
+    const RangeQuery query{0, 0, 25, hostileTypes(NpcType::Dragon)};
+    for (RangeKernel kernel : {RangeKernel::Scalar, RangeKernel::SSE41, RangeKernel::AVX2}) {
+        EXPECT_EQ(rangeMask(kernel, query, {xs.data(), ys.data(), types.data(), 8}), 1ull << 5)
+            << rangeKernelName(kernel);
+    }
+}
+
+TEST(RangeKernelTest, SquaredRangeAgreesWithSqrtComparison) {
+    EXPECT_EQ(squaredRange(10.0), 100);
+    EXPECT_EQ(squaredRange(0.0), 0);
+    EXPECT_EQ(squaredRange(-1.0), -1);
+    EXPECT_EQ(squaredRange(std::nan("")), -1);
+    for (double range : {0.5, 1.5, 7.07, 9.99, 10.01, 123.456}) {
+        int64_t sq = squaredRange(range);
+        EXPECT_LE(std::sqrt(static_cast<double>(sq)), range);
+        EXPECT_GT(std::sqrt(static_cast<double>(sq + 1)), range);
+    }
+    EXPECT_EQ(hostileTypes(NpcType::Dragon), (1u << 1) | (1u << 2));
+    EXPECT_EQ(hostileTypes(NpcType::Unknown), 0u);
+}
+
+TEST(MetricsTest, HistogramUsesPowerOfTwoBuckets) {
+    Histogram histogram;
+    for (uint64_t value : {0, 1, 2, 3, 4, 1000, 1000, 1000}) histogram.record(value);
+
+    EXPECT_EQ(histogram.count(), 8u);
+    EXPECT_EQ(histogram.sum(), 3010u);
+    EXPECT_EQ(histogram.max(), 1000u);
+    EXPECT_EQ(histogram.bucket(0), 1u);  // 0
+    EXPECT_EQ(histogram.bucket(1), 1u);  // 1
+    EXPECT_EQ(histogram.bucket(2), 2u);  // 2..3
+    EXPECT_EQ(histogram.bucket(3), 1u);  // 4..7
+    EXPECT_EQ(histogram.bucket(10), 3u); // 512..1023
+    EXPECT_EQ(Histogram::bucketLimit(10), 1023u);
+    EXPECT_EQ(histogram.quantile(0.0), 0u);
+    EXPECT_EQ(histogram.quantile(0.5), 3u);
+    // граница корзины не больше наибольшего значения
+    EXPECT_EQ(histogram.quantile(1.0), 1000u);
+}
+
+TEST(MetricsTest, SampledTimerRecordsEveryPeriodthPass) {
+    Histogram histogram;
+    for (int i = 0; i < 64; ++i) {
+        LAB7_METRIC_TIME_SAMPLED(histogram, 16);
+    }
+    {
+        LAB7_METRIC_TIME_IF(histogram, false);
+    }
+    PhaseTimer idle(false);
+    idle.lap(histogram);
+    EXPECT_EQ(histogram.count(), LAB7_ENABLE_METRICS ? 4u : 0u);
+
+    Histogram first;
+    Histogram second;
+    PhaseTimer phases(true);
+    phases.lap(first);
+    phases.lap(second);
+    EXPECT_EQ(first.count() + second.count(), LAB7_ENABLE_METRICS ? 2u : 0u);
+
+    // свободная блокировка берётся без записи
+    std::mutex mutex;
+    std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+    lockTimed(lock, histogram);
+    EXPECT_TRUE(lock.owns_lock());
+    EXPECT_EQ(histogram.count(), LAB7_ENABLE_METRICS ? 4u : 0u);
+}
+
+TEST(MetricsTest, ExportsPrometheusTextAndJson) {
+    MetricsRegistry registry;
+    registry.counter("lab7_test_total", "Test counter").add(5);
+    registry.gauge("lab7_test_gauge", "Test gauge").set(-3);
+    Histogram& latency = registry.histogram("lab7_test_seconds", "Test latency", 1e-9);
+    latency.record(1500);
+    latency.record(3000);
+
+    EXPECT_EQ(registry.findCounter("lab7_test_total")->get(), 5u);
+    EXPECT_EQ(registry.findHistogram("lab7_test_seconds"), &latency);
+    EXPECT_EQ(registry.findGauge("lab7_test_total"), nullptr);
+
+    const std::string text = registry.toPrometheus();
+    EXPECT_NE(text.find("# TYPE lab7_test_total counter\nlab7_test_total 5\n"), std::string::npos);
+    EXPECT_NE(text.find("lab7_test_gauge -3\n"), std::string::npos);
+    // 1500 в корзине 1024..2047, 3000 - в 2048..4095; границы в секундах
+    EXPECT_NE(text.find("lab7_test_seconds_bucket{le=\"2.047e-06\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("lab7_test_seconds_bucket{le=\"4.095e-06\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("lab7_test_seconds_bucket{le=\"+Inf\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("lab7_test_seconds_sum 4.5e-06\n"), std::string::npos);
+    EXPECT_NE(text.find("lab7_test_seconds_count 2\n"), std::string::npos);
+
+    const std::string json = registry.toJson();
+    EXPECT_NE(json.find("\"lab7_test_total\": 5"), std::string::npos);
+    EXPECT_NE(json.find("\"lab7_test_seconds\": {\"count\": 2"), std::string::npos);
+    EXPECT_NE(json.find("\"buckets\": [[2.047e-06, 1], [4.095e-06, 1]]"), std::string::npos);
+}
+
+#if LAB7_ENABLE_METRICS
+TEST(MetricsTest, HeadlessRunFillsArenaMetrics) {
+    Arena arena(100, 100);
+    arena.setSeed(4);
+    arena.generateRandomNpcs(100, false);
+    arena.runHeadless(64);
+
+    const MetricsRegistry& metrics = arena.getMetrics();
+    EXPECT_EQ(metrics.findCounter("lab7_ticks_total")->get(), 64u);
+    // фазы замеряются каждый 16-й тик
+    EXPECT_EQ(metrics.findHistogram("lab7_move_seconds")->count(), 4u);
+    EXPECT_EQ(metrics.findHistogram("lab7_pair_scan_seconds")->count(), 4u);
+    EXPECT_EQ(metrics.findHistogram("lab7_battle_queue_depth")->count(), 4u);
+    EXPECT_EQ(metrics.findHistogram("lab7_kills_per_tick")->count(), 4u);
+    // блокировку никто больше не держит: ожиданий нет
+    EXPECT_EQ(metrics.findHistogram("lab7_npcs_lock_wait_seconds")->count(), 0u);
+    // каждый убитый - это NPC, которого больше нет среди живых
+    EXPECT_EQ(metrics.findCounter("lab7_kills_total")->get(), 100u - arena.getAliveCount());
+}
+#endif
+
+TEST(NpcStoreTest, InsertStoresStateInArrays) {
+    NpcStore store;
+    NpcHandle handle = store.insert(NpcFactory::createNpc("Elf", "Elf1", 10, 20));
+
+    EXPECT_TRUE(store.valid(handle));
+    EXPECT_EQ(store.size(), 1u);
+    EXPECT_EQ(store.getX(handle.index), 10);
+    EXPECT_EQ(store.getY(handle.index), 20);
+    EXPECT_TRUE(store.isAlive(handle.index));
+    EXPECT_EQ(store.getTypeId(handle.index), NpcType::Elf);
+    EXPECT_EQ(store.getKillDistance(handle.index), 50);
+
+    // объект NPC читает и меняет состояние через хранилище
+    Npc* npc = store.getObject(handle.index);
+    npc->setPosition(3, 4);
+    EXPECT_EQ(store.getX(handle.index), 3);
+    EXPECT_EQ(store.getY(handle.index), 4);
+    store.kill(handle.index);
+    EXPECT_FALSE(npc->isAlive());
+}
+
+TEST(NpcStoreTest, DuplicateNameThrows) {
+    NpcStore store;
+    store.insert(NpcFactory::createNpc("Dragon", "Same", 0, 0));
+    EXPECT_THROW(store.insert(NpcFactory::createNpc("Elf", "Same", 1, 1)), std::invalid_argument);
+    EXPECT_EQ(store.size(), 1u);
+}
+
+TEST(NpcStoreTest, ErasedHandleBecomesInvalid) {
+    NpcStore store;
+    NpcHandle first = store.insert(NpcFactory::createNpc("Dragon", "A", 0, 0));
+    store.insert(NpcFactory::createNpc("Elf", "B", 1, 1));
+
+    store.erase(first);
+    EXPECT_FALSE(store.valid(first));
+    EXPECT_FALSE(store.find("A").isValid());
+    EXPECT_EQ(store.size(), 1u);
+
+    // слот переиспользуется, но со следующим поколением
+    NpcHandle reused = store.insert(NpcFactory::createNpc("Druid", "C", 2, 2));
+    EXPECT_EQ(reused.index, first.index);
+    EXPECT_NE(reused, first);
+    EXPECT_TRUE(store.valid(reused));
+    EXPECT_EQ(store.find("C"), reused);
+}
+
+TEST(NpcStoreTest, HandlesStayInvalidAfterClear) {
+    NpcStore store;
+    NpcHandle before = store.emplace(NpcType::Dragon, "A", 0, 0);
+    store.clear();
+    EXPECT_FALSE(store.valid(before));
+
+    // новый NPC в том же слоте не принимает старый описатель
+    NpcHandle after = store.emplace(NpcType::Elf, "B", 1, 1);
+    EXPECT_EQ(after.index, before.index);
+    EXPECT_FALSE(store.valid(before));
+    EXPECT_TRUE(store.valid(after));
+}
+
+TEST(NpcStoreTest, NameIndexMatchesSetUnderChurn) {
+    NpcStore store;
+    std::set<std::string> expected;
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<> pick(0, 499);
+
+    for (int step = 0; step < 5000; ++step) {
+        std::string name = "npc_" + std::to_string(pick(gen));
+        NpcHandle handle = store.find(name);
+        EXPECT_EQ(handle.isValid(), expected.count(name) == 1) << name;
+        if (handle.isValid()) {
+            store.erase(handle);
+            expected.erase(name);
+        } else {
+            EXPECT_TRUE(store.tryInsert(NpcFactory::createNpc("Elf", name, 0, 0)).isValid());
+            EXPECT_FALSE(store.tryInsert(NpcFactory::createNpc("Elf", name, 0, 0)).isValid());
+            expected.insert(name);
+        }
+    }
+
+    EXPECT_EQ(store.size(), expected.size());
+    for (const auto& name : expected) {
+        EXPECT_TRUE(store.find(name).isValid()) << name;
+    }
+}
+
+TEST(NpcStoreTest, EmplacedNpcsComeFromPoolAndMixWithHeapOnes) {
+    NpcStore store;
+    NpcHandle dragon = store.emplace(NpcType::Dragon, "a_name_longer_than_small_string_buffer", 3, 4);
+    NpcHandle elf = store.insert(NpcFactory::createNpc("Elf", "Heap", 5, 6));
+    ASSERT_TRUE(dragon.isValid());
+    EXPECT_FALSE(store.emplace(NpcType::Druid, "Heap", 0, 0).isValid());
+    EXPECT_FALSE(store.emplace(NpcType::Unknown, "Nobody", 0, 0).isValid());
+
+    Npc* object = store.getObject(dragon.index);
+    EXPECT_EQ(object->getType(), "Dragon");
+    EXPECT_EQ(object->getName(), "a_name_longer_than_small_string_buffer");
+    EXPECT_EQ(object->getX(), 3);
+    EXPECT_EQ(store.getName(dragon.index), "a_name_longer_than_small_string_buffer");
+
+    // место уничтоженного объекта достаётся следующему NPC того же типа
+    store.erase(dragon);
+    NpcHandle reused = store.emplace(NpcType::Dragon, "Next", 7, 8);
+    EXPECT_EQ(store.getObject(reused.index), object);
+    EXPECT_EQ(object->getName(), "Next");
+    EXPECT_EQ(store.find("Next"), reused);
+
+    store.clear();
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_FALSE(store.find("Heap").isValid());
+    EXPECT_FALSE(store.valid(elf));
+    EXPECT_TRUE(store.emplace(NpcType::Elf, "Heap", 0, 0).isValid());
+}
+
+TEST(NpcPoolTest, ReleaseDropsEveryObjectAtOnce) {
+    NpcPool pool(256);
+    std::vector<Npc*> npcs;
+    for (int i = 0; i < 100; ++i) {
+        npcs.push_back(pool.create(static_cast<NpcType>(i % kNpcTypeCount), "npc_" + std::to_string(i), i, 0));
+    }
+    EXPECT_EQ(pool.getLiveCount(), 100u);
+    EXPECT_EQ(npcs[42]->getName(), "npc_42");
+
+    pool.destroy(npcs[0]);
+    pool.destroy(npcs[3]);
+    Npc* reused = pool.create(NpcType::Dragon, "again", 0, 0);
+    EXPECT_TRUE(reused == npcs[0] || reused == npcs[3]);
+    EXPECT_EQ(pool.getReusedCount(), 1u);
+    EXPECT_EQ(pool.getLiveCount(), 99u);
+
+    pool.release();
+    EXPECT_EQ(pool.getLiveCount(), 0u);
+    EXPECT_EQ(pool.create(NpcType::Elf, "after", 1, 1)->getName(), "after");
+}
+
+namespace {
+
+// считает байты, запрошенные у вышестоящего ресурса
+class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t allocated = 0;
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            allocated += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+};
+
+}
+
+TEST(NpcPoolTest, RecycledNamesDoNotGrowTheBuffer) {
+    CountingResource upstream;
+    NpcPool pool(256, &upstream);
+    // имена длиннее встроенного буфера строки берутся из пула
+    auto churn = [&pool](int from, int to) {
+        for (int i = from; i < to; ++i) {
+            Npc* npc = pool.create(NpcType::Elf, "a_rather_long_npc_name_" + std::to_string(i), 0, 0);
+            pool.destroy(npc);
+        }
+    };
+    churn(0, 100);
+    const size_t warmed = upstream.allocated;
+    churn(100, 20000);
+    EXPECT_EQ(upstream.allocated, warmed);
+    EXPECT_EQ(pool.getLiveCount(), 0u);
+}
+
+TEST(ArenaTest, ClearAndRegenerateReusesThePool) {
+    Arena arena(100, 100);
+    arena.setSeed(9);
+    for (int round = 0; round < 3; ++round) {
+        arena.generateRandomNpcs(200, false);
+        EXPECT_EQ(arena.getNpcCount(), 200u);
+        arena.createAndAddNpc("Druid", "extra", 50, 50);
+        EXPECT_THROW(arena.createAndAddNpc("Druid", "extra", 1, 1), std::invalid_argument);
+        EXPECT_THROW(arena.createAndAddNpc("Elf", "outside", 101, 0), std::out_of_range);
+        EXPECT_THROW(arena.createAndAddNpc("Orc", "unknown", 0, 0), std::invalid_argument);
+        arena.clear();
+        EXPECT_EQ(arena.getNpcCount(), 0u);
+    }
+}
+
+TEST(ArenaTest, ClearDropsQueuedBattles) {
+    Arena arena(20, 20);
+    arena.setSeed(4);
+    arena.generateRandomNpcs(100, false);
+    arena.tick();
+    ASSERT_GT(arena.getPendingBattles(), 0u);
+
+    arena.clear();
+    EXPECT_EQ(arena.getPendingBattles(), 0u);
+    arena.generateRandomNpcs(100, false);
+    EXPECT_EQ(arena.drainBattles(1), 0u);
+}
+
+TEST(NpcStateTest, PacksNegativeAndLargeCoordinates) {
+    NpcState state(-5, -100000, true);
+    NpcState::Value value = state.load();
+    EXPECT_EQ(value.x, -5);
+    EXPECT_EQ(value.y, -100000);
+    EXPECT_TRUE(value.alive);
+
+    state.setPosition(100000, 99999);
+    EXPECT_EQ(state.getX(), 100000);
+    EXPECT_EQ(state.getY(), 99999);
+}
+
+TEST(NpcStateTest, KillReportsOnlyFirstCaller) {
+    NpcState state(1, 2, true);
+    EXPECT_TRUE(state.kill());
+    EXPECT_FALSE(state.kill());
+    EXPECT_FALSE(state.isAlive());
+
+    // передвижение не воскрешает мёртвого NPC
+    state.setPosition(3, 4);
+    EXPECT_FALSE(state.isAlive());
+    EXPECT_EQ(state.getX(), 3);
+}
+
+TEST(NpcStateTest, ConcurrentKillHasSingleWinner) {
+    for (int round = 0; round < 50; ++round) {
+        NpcState state(0, 0, true);
+        std::atomic<int> winners{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&] {
+                if (state.kill()) winners++;
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        EXPECT_EQ(winners.load(), 1);
+    }
+}
+
+TEST(RingBufferTest, FifoAndCapacity) {
+    MpmcRingBuffer<int> ring(3);
+    EXPECT_EQ(ring.capacity(), 4u);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.tryPush(i));
+    }
+    EXPECT_FALSE(ring.tryPush(4));
+    EXPECT_EQ(ring.size(), 4u);
+
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.tryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(ring.tryPop(value));
+}
+
+TEST(RingBufferTest, ConcurrentProducersAndConsumers) {
+    MpmcRingBuffer<long> ring(64);
+    const long perProducer = 20000;
+    std::atomic<long> sum{0};
+    std::atomic<long> popped{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 2; ++p) {
+        threads.emplace_back([&] {
+            for (long i = 1; i <= perProducer; ++i) {
+                while (!ring.tryPush(i)) std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < 2; ++c) {
+        threads.emplace_back([&] {
+            long value;
+            while (popped.load() < 2 * perProducer) {
+                if (ring.tryPop(value)) {
+                    sum += value;
+                    popped++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(sum.load(), 2 * perProducer * (perProducer + 1) / 2);
+}
+
+TEST(BattleQueueTest, DropPolicyCountsDroppedTasks) {
+    BattleQueue queue(1, {4, OverflowPolicy::Drop});
+    std::atomic<bool> canWait{false};
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        queue.push({{i, 0}, {i + 100, 0}}, canWait);
+    }
+
+    BattleQueueStats stats = queue.getStats();
+    EXPECT_EQ(stats.enqueued, 4u);
+    EXPECT_EQ(stats.dropped, 6u);
+    EXPECT_EQ(queue.size(), 4u);
+}
+
+TEST(BattleQueueTest, BackpressureWaitsUntilPopFreesSpace) {
+    BattleQueue queue(1, {2, OverflowPolicy::Backpressure});
+    std::atomic<bool> canWait{true};
+    queue.push({{0, 0}, {100, 0}}, canWait);
+    queue.push({{1, 0}, {101, 0}}, canWait);
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&] {
+        pushed = queue.push({{2, 0}, {102, 0}}, canWait);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed);
+
+    BattleTask task;
+    ASSERT_TRUE(queue.pop(0, task));
+    producer.join();
+    EXPECT_TRUE(pushed);
+    EXPECT_EQ(queue.size(), 2u);
+    EXPECT_EQ(queue.getStats().dropped, 0u);
+}
+
+TEST(BattleQueueTest, DuplicatePendingPairIsCoalesced) {
+    BattleQueue queue(1, {8, OverflowPolicy::Drop});
+    std::atomic<bool> canWait{false};
+
+    EXPECT_TRUE(queue.push({{1, 0}, {2, 0}}, canWait));
+    // та же пара в обратном порядке объединяется с ожидающей
+    EXPECT_FALSE(queue.push({{2, 0}, {1, 0}}, canWait));
+    EXPECT_EQ(queue.size(), 1u);
+
+    BattleTask task;
+    ASSERT_TRUE(queue.pop(0, task));
+    // бой взят, но не разрешён - пара всё ещё ожидающая
+    EXPECT_FALSE(queue.push({{1, 0}, {2, 0}}, canWait));
+    queue.complete(task);
+    EXPECT_TRUE(queue.push({{1, 0}, {2, 0}}, canWait));
+
+    BattleQueueStats stats = queue.getStats();
+    EXPECT_EQ(stats.enqueued, 2u);
+    EXPECT_EQ(stats.coalesced, 2u);
+    EXPECT_EQ(stats.dropped, 0u);
+}
+
+TEST(BattleQueueTest, PopStealsFromOtherShards) {
+    BattleQueue queue(4, {64, OverflowPolicy::Drop});
+    std::atomic<bool> canWait{false};
+    for (uint32_t i = 0; i < 8; ++i) {
+        queue.push({{i, 0}, {i + 100, 0}}, canWait);
+    }
+
+    BattleTask task;
+    size_t popped = 0;
+    while (queue.pop(0, task)) popped++;
+    EXPECT_EQ(popped, 8u);
+    EXPECT_EQ(queue.size(), 0u);
+}
+
+TEST(PendingPairSetTest, KeyIgnoresOrder) {
+    EXPECT_EQ(PendingPairSet::pairKey(3, 7), PendingPairSet::pairKey(7, 3));
+    EXPECT_NE(PendingPairSet::pairKey(3, 7), PendingPairSet::pairKey(3, 8));
+}
+
+TEST(PendingPairSetTest, MatchesStdSetUnderChurn) {
+    PendingPairSet pending(64);
+    std::set<uint64_t> reference;
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<uint32_t> id(0, 40);
+
+    // много вставок и удалений в маленькой таблице: надгробия должны вычищаться
+    for (int step = 0; step < 20000; ++step) {
+        uint64_t key = PendingPairSet::pairKey(id(gen), id(gen));
+        if (reference.size() < 24 && gen() % 2 == 0) {
+            EXPECT_EQ(pending.insert(key) == PendingPairSet::InsertResult::Inserted,
+                      reference.insert(key).second);
+        } else {
+            pending.erase(key);
+            reference.erase(key);
+        }
+        ASSERT_EQ(pending.size(), reference.size());
+    }
+    for (uint32_t a = 0; a <= 40; ++a) {
+        for (uint32_t b = a; b <= 40; ++b) {
+            uint64_t key = PendingPairSet::pairKey(a, b);
+            EXPECT_EQ(pending.contains(key), reference.count(key) == 1);
+        }
+    }
+}
+
+TEST(PendingPairSetTest, FullTableDoesNotClaimTheKey) {
+    PendingPairSet pending(16);
+    for (uint32_t i = 0; i < 16; ++i) {
+        ASSERT_EQ(pending.insert(PendingPairSet::pairKey(i, 100)), PendingPairSet::InsertResult::Inserted);
+    }
+    const uint64_t extra = PendingPairSet::pairKey(16, 100);
+    EXPECT_EQ(pending.insert(extra), PendingPairSet::InsertResult::Full);
+    EXPECT_FALSE(pending.contains(extra));
+    EXPECT_EQ(pending.size(), 16u);
+
+    pending.erase(PendingPairSet::pairKey(0, 100));
+    EXPECT_EQ(pending.insert(extra), PendingPairSet::InsertResult::Inserted);
+    EXPECT_TRUE(pending.contains(extra));
+}
+
+TEST(PendingPairSetTest, CompactionKeepsTombstonesBounded) {
+    PendingPairSet pending(64);
+    // ключи живут долго и перемежаются удалёнными - надгробия не в концах цепочек
+    std::vector<uint64_t> live;
+    for (uint32_t step = 0; step < 20000; ++step) {
+        uint64_t key = PendingPairSet::pairKey(step, step + 1);
+        ASSERT_EQ(pending.insert(key), PendingPairSet::InsertResult::Inserted);
+        live.push_back(key);
+        if (live.size() > 24) {
+            pending.erase(live[step % live.size()]);
+            live.erase(live.begin() + step % live.size());
+        }
+        ASSERT_LE(pending.tombstones(), pending.capacity() / 2);
+    }
+    for (uint64_t key : live) {
+        EXPECT_TRUE(pending.contains(key));
+    }
+    EXPECT_EQ(pending.size(), live.size());
+}
+
+TEST(PendingPairSetTest, ConcurrentEraseSurvivesCompaction) {
+    PendingPairSet pending(64);
+    MpmcRingBuffer<uint64_t> handoff(32);
+    const uint32_t total = 50000;
+
+    // удаляющий поток отстаёт на длину очереди, добавляющий тем временем уплотняет таблицу
+    std::thread eraser([&] {
+        uint64_t key;
+        for (uint32_t erased = 0; erased < total;) {
+            if (handoff.tryPop(key)) {
+                pending.erase(key);
+                erased++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (uint32_t i = 0; i < total; ++i) {
+        uint64_t key = PendingPairSet::pairKey(i, i + 7);
+        while (pending.insert(key) == PendingPairSet::InsertResult::Full) std::this_thread::yield();
+        while (!handoff.tryPush(key)) std::this_thread::yield();
+    }
+    eraser.join();
+
+    EXPECT_EQ(pending.size(), 0u);
+    for (uint32_t i = total - 64; i < total; ++i) {
+        EXPECT_FALSE(pending.contains(PendingPairSet::pairKey(i, i + 7)));
+    }
+}
+
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+}
+
+TEST(FileObserverTest, BuffersUntilSizeThreshold) {
+    const std::string path = "test_file_observer.log";
+    std::remove(path.c_str());
+
+    FileObserverConfig config;
+    config.buffer_size = 64;
+    config.flush_interval = std::chrono::hours(1);
+    {
+        FileObserver observer(path, config);
+        observer.notify("short event");
+        EXPECT_EQ(readFile(path), "");
+        EXPECT_EQ(observer.getStats().flushes, 0u);
+
+        observer.notifyBatch(std::vector<std::string>(8, "another event"));
+        EXPECT_GT(observer.getStats().flushes, 0u);
+        EXPECT_FALSE(readFile(path).empty());
+
+        observer.flush();
+        EXPECT_EQ(observer.getStats().bytes_written, readFile(path).size());
+    }
+    EXPECT_EQ(readFile(path).size(), 12u + 8 * 14u);
+    std::remove(path.c_str());
+}
+
+TEST(FileObserverTest, RotatesAtConfiguredSize) {
+    const std::string path = "test_file_observer_rotate.log";
+    for (const char* suffix : {"", ".1", ".2", ".3"}) {
+        std::remove((path + suffix).c_str());
+    }
+
+    FileObserverConfig config;
+    config.buffer_size = 1;
+    config.rotate_size = 100;
+    config.max_rotated_files = 2;
+    {
+        FileObserver observer(path, config);
+        for (int i = 0; i < 100; ++i) {
+            observer.notify("event number " + std::to_string(i));
+        }
+        EXPECT_GT(observer.getStats().rotations, 2u);
+    }
+
+    EXPECT_LE(readFile(path).size(), 100u);
+    EXPECT_FALSE(readFile(path + ".1").empty());
+    EXPECT_FALSE(readFile(path + ".2").empty());
+    EXPECT_TRUE(readFile(path + ".3").empty());
+    EXPECT_NE(readFile(path).find("event number 99"), std::string::npos);
+
+    for (const char* suffix : {"", ".1", ".2"}) {
+        std::remove((path + suffix).c_str());
+    }
+}
+
+
+TEST(MapRendererTest, FullFrameMatchesMapLayout) {
+    MapRenderer renderer(10, 2);
+    renderer.beginFrame();
+    renderer.plot(0, 0, 'D');
+    renderer.plot(10, 2, 'E');
+    renderer.plot(11, 0, 'R');
+    renderer.setCounts(3, 4);
+
+    const std::string frame = renderer.render(MapRenderer::Mode::Full);
+    EXPECT_EQ(frame,
+              "\n========== MAP ==========\n"
+              "  2 | ..........E\n"
+              "  1 | ...........\n"
+              "  0 | D..........\n"
+              "    +-----------+\n"
+              "      0       10\n"
+              "\nAlive: 3 / 4\n========================\n\n");
+}
+
+TEST(MapRendererTest, ViewportShiftsLabelsAndSkipsOutside) {
+    MapRenderer renderer(10, 1, 1000, 2000);
+    renderer.beginFrame();
+    renderer.plot(1000, 2000, 'D');
+    renderer.plot(1010, 2001, 'E');
+    renderer.plot(5, 5, 'R');
+    renderer.setCounts(3, 3);
+
+    const std::string frame = renderer.render(MapRenderer::Mode::Full);
+    EXPECT_EQ(frame,
+              "\n========== MAP ==========\n"
+              "2001 | ..........E\n"
+              "2000 | D..........\n"
+              "     +-----------+\n"
+              "       1000  1010\n"
+              "\nAlive: 3 / 3\n========================\n\n");
+}
+
+TEST(MapRendererTest, DiffFrameTouchesOnlyChangedCells) {
+    MapRenderer renderer(10, 2);
+    renderer.beginFrame();
+    renderer.plot(1, 1, 'D');
+    renderer.plot(5, 0, 'E');
+    renderer.render(MapRenderer::Mode::Diff);
+
+    // D сдвинулся на клетку, E остался на месте
+    renderer.beginFrame();
+    renderer.plot(2, 1, 'D');
+    renderer.plot(5, 0, 'E');
+    const std::string diff = renderer.render(MapRenderer::Mode::Diff);
+
+    EXPECT_EQ(renderer.getChangedCells().size(), 2u);
+    EXPECT_NE(diff.find("\x1b[4;8H."), std::string::npos);
+    EXPECT_NE(diff.find("\x1b[4;9HD"), std::string::npos);
+    EXPECT_EQ(diff.find("E"), std::string::npos);
+}
+
+TEST(SnapshotPublisherTest, HeldSnapshotSurvivesPublish) {
+    SnapshotPublisher<int> publisher;
+    EXPECT_FALSE(publisher.acquire());
+
+    publisher.publish(std::make_unique<int>(1));
+    {
+        auto held = publisher.acquire();
+        publisher.publish(std::make_unique<int>(2));
+        // старый снимок удерживает читатель, удалять его нельзя
+        EXPECT_EQ(*held, 1);
+        EXPECT_EQ(publisher.getRetiredCount(), 1u);
+        EXPECT_EQ(*publisher.acquire(), 2);
+    }
+
+    publisher.publish(std::make_unique<int>(3));
+    EXPECT_EQ(publisher.getRetiredCount(), 0u);
+}
+
+TEST(SnapshotPublisherTest, ArenaSnapshotFollowsChanges) {
+    Arena arena;
+    arena.createAndAddNpc("Dragon", "Smaug", 10, 20);
+    auto first = arena.snapshot();
+    ASSERT_TRUE(first);
+    ASSERT_EQ(first->npcs.size(), 1u);
+    EXPECT_EQ(first->nameOf(first->npcs[0]), "Smaug");
+
+    arena.createAndAddNpc("Elf", "Legolas", 30, 40);
+    auto second = arena.snapshot();
+    EXPECT_EQ(second->npcs.size(), 2u);
+    EXPECT_EQ(second->alive, 2u);
+    // прежний снимок не меняется
+    EXPECT_EQ(first->npcs.size(), 1u);
+}
+
+TEST(ArenaTest, LargeWorldKeepsNpcsInBounds) {
+    Arena arena(100000, 100000);
+    arena.setSeed(7);
+    arena.generateRandomNpcs(1000, false);
+    arena.createAndAddNpc("Dragon", "FarDragon", 100000, 100000);
+    arena.runHeadless(5);
+
+    auto world = arena.snapshot();
+    EXPECT_EQ(world->npcs.size(), 1001u);
+    for (const auto& npc : world->npcs) {
+        EXPECT_GE(npc.x, 0);
+        EXPECT_LE(npc.x, 100000);
+        EXPECT_GE(npc.y, 0);
+        EXPECT_LE(npc.y, 100000);
+    }
+    EXPECT_THROW(arena.createAndAddNpc("Elf", "Outside", 100001, 0), std::out_of_range);
+}
+
+TEST(NpcLoaderTest, ParseCollectsErrorsWithLineNumbers) {
+    const std::string text =
+        "Dragon Smaug 10 20\n"
+        "\n"
+        "Elf Legolas 1 x\n"
+        "Goblin Grub 1 2\r\n"
+        "Druid Radagast\t5 7\r\n"
+        "Elf Tauriel -1 3";
+
+    std::vector<NpcRecord> records;
+    std::vector<LoadError> errors;
+    EXPECT_EQ(parseNpcRecords(text, records, errors), 5u);
+
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].type, NpcType::Dragon);
+    EXPECT_EQ(records[0].name, "Smaug");
+    EXPECT_EQ(records[1].name, "Radagast");
+    EXPECT_EQ(records[1].x, 5);
+    EXPECT_EQ(records[1].y, 7);
+    EXPECT_EQ(records[1].line, 5u);
+
+    ASSERT_EQ(errors.size(), 3u);
+    EXPECT_EQ(errors[0].line, 3u);
+    EXPECT_EQ(errors[1].line, 4u);
+    EXPECT_EQ(errors[2].line, 6u);
+}
+
+TEST(NpcLoaderTest, ArenaLoadReportsSkippedLines) {
+    const std::string filename = "test_loader_arena.txt";
+    {
+        std::ofstream file(filename);
+        file << "Dragon Smaug 10 20\n"
+             << "Elf Smaug 1 1\n"
+             << "Elf Legolas 500 1\n"
+             << "Druid Radagast 5 7\n"
+             << "broken\n";
+    }
+
+    Arena arena(100, 100);
+    LoadReport report = arena.loadFromFile(filename);
+    EXPECT_EQ(report.lines, 5u);
+    EXPECT_EQ(report.loaded, 2u);
+    ASSERT_EQ(report.errors.size(), 3u);
+    EXPECT_EQ(report.errors[0].line, 2u);
+    EXPECT_EQ(report.errors[1].line, 3u);
+    EXPECT_EQ(report.errors[2].line, 5u);
+    EXPECT_EQ(arena.getNpcCount(), 2u);
+
+    // сохранённый файл загружается без ошибок
+    arena.saveToFile(filename);
+    Arena copy(100, 100);
+    report = copy.loadFromFile(filename);
+    EXPECT_TRUE(report.ok());
+    EXPECT_EQ(copy.getNpcCount(), 2u);
+    std::remove(filename.c_str());
+
+    EXPECT_THROW(copy.loadFromFile("no_such_file.txt"), std::runtime_error);
+}
+
+TEST(NpcLoaderTest, BinarySnapshotRoundTripAndChecksum) {
+    const std::string filename = "test_loader_binary.bin";
+    Arena arena(1000, 1000);
+    arena.createAndAddNpc("Dragon", "Smaug", 999, 0);
+    arena.createAndAddNpc("Elf", "Legolas", 3, 4);
+    arena.createAndAddNpc("Druid", "Radagast", 5, 6);
+    arena.getAliveNpcs()[1]->kill();
+    arena.saveToFile(filename, SaveFormat::Binary);
+
+    Arena copy(1000, 1000);
+    LoadReport report = copy.loadFromFile(filename);
+    EXPECT_TRUE(report.ok());
+    EXPECT_EQ(report.loaded, 3u);
+    EXPECT_EQ(report.bytes, sizeof(BinarySnapshotHeader) + 3 * sizeof(BinaryNpcRecord) + 5 + 7 + 8);
+    EXPECT_EQ(copy.getAliveCount(), 2u);
+    auto world = copy.snapshot();
+    ASSERT_EQ(world->npcs.size(), 3u);
+    EXPECT_EQ(world->nameOf(world->npcs[0]), "Smaug");
+    EXPECT_EQ(world->npcs[0].x, 999);
+    EXPECT_EQ(world->npcs[2].type, NpcType::Druid);
+
+    // испорченный байт в таблице имён
+    {
+        std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put('X');
+    }
+    Arena broken(1000, 1000);
+    EXPECT_THROW(broken.loadFromFile(filename), std::runtime_error);
+    EXPECT_EQ(broken.getNpcCount(), 0u);
+    std::remove(filename.c_str());
+}
+
+namespace {
+
+std::map<std::string, std::tuple<int, int, bool>> worldByName(const Arena& arena) {
+    std::map<std::string, std::tuple<int, int, bool>> result;
+    auto world = arena.snapshot();
+    for (const auto& npc : world->npcs) {
+        result[world->nameOf(npc)] = {npc.x, npc.y, npc.alive};
+    }
+    return result;
+}
+
+}
+
+TEST(CheckpointTest, DeltasRestoreTheLatestState) {
+    const auto directory = std::filesystem::temp_directory_path() / "lab7_checkpoint_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    Arena arena(100, 100);
+    arena.setSeed(3);
+    arena.generateRandomNpcs(40, false);
+    Checkpointer checkpointer(arena, {directory.string(), std::chrono::milliseconds(1000), 3});
+    checkpointer.checkpointNow();
+
+    // движение, смерти, новый NPC и удаления между точками
+    arena.runHeadless(10);
+    arena.createAndAddNpc("Elf", "Late", 1, 1);
+    checkpointer.checkpointNow();
+    arena.startBattle(30.0);
+    checkpointer.checkpointNow();
+
+    CheckpointStats stats = checkpointer.getStats();
+    EXPECT_EQ(stats.full, 1u);
+    EXPECT_EQ(stats.deltas, 2u);
+
+    Arena restored(100, 100);
+    LoadReport report = restored.restoreCheckpoint(directory.string());
+    EXPECT_TRUE(report.ok());
+    EXPECT_EQ(restored.getSeed(), 3u);
+    EXPECT_EQ(restored.getTickCount(), arena.getTickCount());
+    EXPECT_EQ(worldByName(restored), worldByName(arena));
+
+    // новый полный снимок вытесняет старую цепочку
+    checkpointer.checkpointNow();
+    size_t files = 0;
+    for (const auto& file : std::filesystem::directory_iterator(directory)) {
+        (void)file;
+        files++;
+    }
+    EXPECT_EQ(files, 2u);
+
+    // текстовое сохранение не воскрешает погибших
+    const std::string text = (directory / "world.txt").string();
+    arena.saveToFile(text);
+    Arena fromText(100, 100);
+    EXPECT_EQ(fromText.loadFromFile(text).loaded, arena.getAliveCount());
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(CheckpointTest, ReopenedDirectoryContinuesNumbering) {
+    const auto directory = std::filesystem::temp_directory_path() / "lab7_checkpoint_reopen_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    Arena arena(100, 100);
+    arena.setSeed(9);
+    arena.generateRandomNpcs(20, false);
+    {
+        Checkpointer checkpointer(arena, {directory.string(), std::chrono::milliseconds(1000), 10});
+        for (int i = 0; i < 3; ++i) {
+            arena.runHeadless(2);
+            checkpointer.checkpointNow();
+        }
+    }
+
+    // новая игра в том же каталоге: номера идут дальше, файлы прошлой удаляются
+    Arena next(100, 100);
+    next.setSeed(10);
+    next.generateRandomNpcs(15, false);
+    Checkpointer checkpointer(next, {directory.string(), std::chrono::milliseconds(1000), 10});
+    checkpointer.checkpointNow();
+
+    std::vector<std::string> files;
+    for (const auto& file : std::filesystem::directory_iterator(directory)) {
+        files.push_back(file.path().filename().string());
+    }
+    std::sort(files.begin(), files.end());
+    EXPECT_EQ(files, (std::vector<std::string>{"checkpoint_00000004.bin", "manifest.txt"}));
+
+    Arena restored(100, 100);
+    EXPECT_TRUE(restored.restoreCheckpoint(directory.string()).ok());
+    EXPECT_EQ(worldByName(restored), worldByName(next));
+    std::filesystem::remove_all(directory);
+}
+
+TEST(CheckpointTest, FailedManifestWriteKeepsTheChain) {
+    const auto directory = std::filesystem::temp_directory_path() / "lab7_checkpoint_fail_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    Arena arena(100, 100);
+    arena.setSeed(5);
+    arena.generateRandomNpcs(20, false);
+    Checkpointer checkpointer(arena, {directory.string(), std::chrono::milliseconds(1000), 10});
+    checkpointer.checkpointNow();
+
+    // каталог на месте временного манифеста: файл точки пишется, манифест - нет
+    arena.createAndAddNpc("Elf", "Late", 1, 1);
+    std::filesystem::create_directories(directory / "manifest.tmp");
+    EXPECT_THROW(checkpointer.checkpointNow(), std::exception);
+    std::filesystem::remove_all(directory / "manifest.tmp");
+
+    arena.runHeadless(5);
+    checkpointer.checkpointNow();
+
+    std::ifstream manifest(directory / "manifest.txt");
+    std::string line;
+    size_t points = 0;
+    while (std::getline(manifest, line)) {
+        if (line.rfind("seed", 0) != 0) points++;
+    }
+    EXPECT_EQ(points, 2u);
+
+    Arena restored(100, 100);
+    EXPECT_TRUE(restored.restoreCheckpoint(directory.string()).ok());
+    EXPECT_EQ(worldByName(restored), worldByName(arena));
+
+    // последняя точка в stop() не бросает, даже если каталога уже нет
+    checkpointer.start();
+    std::filesystem::remove_all(directory);
+    EXPECT_NO_THROW(checkpointer.stop());
+    EXPECT_EQ(checkpointer.getStats().failures, 1u);
+}
\ No newline at end of file
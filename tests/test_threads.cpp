@@ -1,10 +1,22 @@
 #include <gtest/gtest.h>
 #include "../include/arena.h"
+#include "../include/batch_runner.h"
+#include "../include/checkpointer.h"
 #include "../include/factory.h"
 #include "../include/console_observer.h"
 #include "../include/file_observer.h"
+#include "../include/tick_pipeline.h"
 #include <thread>
 #include <chrono>
+#include <filesystem>
+#include <tuple>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <map>
+#include <atomic>
+#include <mutex>
+#include <set>
 
 TEST(AsyncThreadsTest, GenerateRandomNpcs) {
     Arena arena(100, 100);
@@ -154,4 +166,421 @@ TEST(AsyncThreadsTest, EmptyArenaAsyncGame) {
         arena.startGame(1);
         std::this_thread::sleep_for(std::chrono::milliseconds(1100));
     });
+}
+
+TEST(AsyncThreadsTest, MultipleBattleWorkersGame) {
+    Arena arena(100, 100);
+    arena.generateRandomNpcs(20);
+
+    EXPECT_NO_THROW(arena.startGame(1, 4));
+    EXPECT_LE(arena.getAliveCount(), 20);
+}
+
+namespace {
+
+class DeathCounter : public Observer {
+    public:
+        void notify(const std::string& event) override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            deaths_ += event.find("killed each other") != std::string::npos ? 2 : 1;
+        }
+        size_t deaths() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return deaths_;
+        }
+    private:
+        mutable std::mutex mutex_;
+        size_t deaths_ = 0;
+};
+
+}
+
+TEST(AsyncThreadsTest, ParallelBattlesReportEachDeathOnce) {
+    Arena arena(100, 100);
+    auto counter = std::make_shared<DeathCounter>();
+    arena.addObserver(counter);
+
+    // все в одной точке: каждый эльф в бою со всеми друидами сразу
+    for (int i = 0; i < 30; ++i) {
+        arena.createAndAddNpc("Elf", "Elf_" + std::to_string(i), 50, 50);
+        arena.createAndAddNpc("Druid", "Druid_" + std::to_string(i), 50, 50);
+    }
+
+    arena.setBattleWorkers(4);
+    for (int round = 0; round < 5; ++round) {
+        arena.tick();
+        arena.drainBattles(4);
+    }
+
+    EXPECT_EQ(counter->deaths(), 60 - arena.getAliveCount());
+}
+
+TEST(AsyncThreadsTest, BattleQueueStaysBounded) {
+    Arena arena(100, 100);
+    arena.configureBattleQueue({256, OverflowPolicy::Drop});
+    for (int i = 0; i < 200; ++i) {
+        arena.createAndAddNpc(i % 2 ? "Elf" : "Druid", "npc_" + std::to_string(i), 50, 50);
+    }
+
+    for (int round = 0; round < 3; ++round) {
+        arena.tick();
+        EXPECT_LE(arena.getPendingBattles(), 256u);
+    }
+    BattleQueueStats stats = arena.getBattleQueueStats();
+    EXPECT_EQ(stats.enqueued, 256u);
+    EXPECT_GT(stats.dropped, 0u);
+}
+
+namespace {
+
+class RecordingObserver : public Observer {
+    public:
+        void notify(const std::string& event) override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            events_.push_back(event);
+        }
+        void notifyBatch(const std::vector<std::string>& events) override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            events_.insert(events_.end(), events.begin(), events.end());
+            batches_++;
+        }
+        size_t count() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return events_.size();
+        }
+        size_t batches() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return batches_;
+        }
+        std::vector<std::string> snapshot() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return events_;
+        }
+    private:
+        mutable std::mutex mutex_;
+        std::vector<std::string> events_;
+        size_t batches_ = 0;
+};
+
+}
+
+TEST(AsyncThreadsTest, EventBusDeliversBatchesAndDrainsOnStop) {
+    EventBus bus;
+    auto observer = std::make_shared<RecordingObserver>();
+    bus.addObserver(observer);
+    bus.setFlushInterval(std::chrono::milliseconds(1000));
+
+    bus.start();
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; ++p) {
+        producers.emplace_back([&bus, p] {
+            for (int i = 0; i < 500; ++i) {
+                bus.publish("event " + std::to_string(p) + "/" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    // интервал большой: всё, что не ушло пачкой раньше, доставит stop()
+    bus.stop();
+
+    EXPECT_EQ(observer->count(), 2000u);
+    EXPECT_GE(observer->batches(), 1u);
+    EXPECT_EQ(bus.getDeliveredCount(), 2000u);
+}
+
+TEST(AsyncThreadsTest, WaitUntilDeliveredDoesNotWaitForFlushInterval) {
+    EventBus bus;
+    auto observer = std::make_shared<RecordingObserver>();
+    bus.addObserver(observer);
+    bus.setFlushInterval(std::chrono::milliseconds(10000));
+    bus.start();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i) {
+        bus.publish("event " + std::to_string(i));
+    }
+    bus.waitUntilDelivered();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    EXPECT_EQ(observer->count(), 100u);
+    bus.stop();
+}
+
+namespace {
+
+// первая пачка задерживает диспетчер, и маленький буфер шины переполняется
+class StallingObserver : public RecordingObserver {
+    public:
+        void notifyBatch(const std::vector<std::string>& events) override {
+            if (!stalled_.exchange(true)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            }
+            RecordingObserver::notifyBatch(events);
+        }
+        void notify(const std::string& event) override {
+            notifyBatch({event});
+        }
+    private:
+        std::atomic<bool> stalled_{false};
+};
+
+}
+
+TEST(AsyncThreadsTest, EventBusKeepsEventTextWhenBufferIsFull) {
+    EventBus bus(4);
+    auto observer = std::make_shared<StallingObserver>();
+    bus.addObserver(observer);
+    bus.start();
+
+    std::vector<std::string> expected;
+    for (int i = 0; i < 40; ++i) {
+        expected.push_back("event " + std::to_string(i));
+        bus.publish(expected.back());
+    }
+    bus.stop();
+
+    EXPECT_EQ(observer->snapshot(), expected);
+}
+
+TEST(AsyncThreadsTest, EventBusIsSynchronousWhenStopped) {
+    EventBus bus;
+    auto observer = std::make_shared<RecordingObserver>();
+    bus.addObserver(observer);
+
+    bus.publish("immediate");
+    EXPECT_EQ(observer->count(), 1u);
+    EXPECT_EQ(observer->batches(), 0u);
+}
+
+namespace {
+
+std::vector<std::string> headlessRun(uint64_t seed, std::vector<std::string>& events) {
+    Arena arena(100, 100);
+    auto recorder = std::make_shared<RecordingObserver>();
+    arena.addObserver(recorder);
+    arena.setSeed(seed);
+    arena.generateRandomNpcs(60, false);
+    arena.runHeadless(300);
+
+    events = recorder->snapshot();
+    std::vector<std::string> survivors;
+    for (Npc* npc : arena.getAliveNpcs()) {
+        survivors.push_back(npc->getName() + "@" + std::to_string(npc->getX()) + "," +
+                            std::to_string(npc->getY()));
+    }
+    return survivors;
+}
+
+}
+
+TEST(AsyncThreadsTest, HeadlessRunIsReproducibleForSeed) {
+    std::vector<std::string> eventsA, eventsB, eventsC;
+    auto survivorsA = headlessRun(42, eventsA);
+    auto survivorsB = headlessRun(42, eventsB);
+    auto survivorsC = headlessRun(43, eventsC);
+
+    EXPECT_FALSE(eventsA.empty());
+    EXPECT_EQ(eventsA, eventsB);
+    EXPECT_EQ(survivorsA, survivorsB);
+    EXPECT_NE(eventsA, eventsC);
+}
+
+TEST(AsyncThreadsTest, BatchRunnerIsIndependentOfThreadCount) {
+    BatchConfig config;
+    config.simulations = 24;
+    config.npc_count = 30;
+    config.ticks = 100;
+    config.base_seed = 7;
+
+    config.threads = 1;
+    BatchResult single = BatchRunner(config).run();
+    config.threads = 4;
+    BatchResult parallel = BatchRunner(config).run();
+
+    EXPECT_EQ(single.simulations, 24u);
+    EXPECT_EQ(parallel.simulations, 24u);
+    for (size_t t = 0; t < kNpcTypeCount; ++t) {
+        EXPECT_NEAR(single.by_type[t].survivors.mean(), parallel.by_type[t].survivors.mean(), 1e-9);
+        EXPECT_NEAR(single.by_type[t].survivors.variance(), parallel.by_type[t].survivors.variance(), 1e-9);
+        EXPECT_EQ(single.by_type[t].histogram, parallel.by_type[t].histogram);
+    }
+}
+
+TEST(AsyncThreadsTest, ParallelMovementMatchesSingleThread) {
+    auto run = [](size_t threads) {
+        Arena arena(3000, 3000);
+        arena.setSeed(5);
+        arena.setWorkerThreads(threads);
+        arena.generateRandomNpcs(10000, false);
+        size_t battles = arena.runHeadless(5);
+
+        std::vector<std::tuple<uint32_t, int, int, bool>> state;
+        auto world = arena.snapshot();
+        for (const auto& entry : world->npcs) {
+            state.emplace_back(entry.handle.index, entry.x, entry.y, entry.alive);
+        }
+        return std::make_pair(battles, state);
+    };
+
+    auto single = run(1);
+    auto parallel = run(4);
+    EXPECT_GT(single.first, 0u);
+    EXPECT_EQ(single.first, parallel.first);
+    EXPECT_EQ(single.second, parallel.second);
+}
+
+TEST(AsyncThreadsTest, WorkerThreadsCannotChangeDuringGame) {
+    Arena arena(100, 100);
+    arena.setSeed(2);
+    arena.generateRandomNpcs(20, false);
+
+    std::thread game_thread([&arena]() {
+        arena.startGame(1);
+    });
+    while (arena.getTickCount() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_THROW(arena.setWorkerThreads(2), std::runtime_error);
+    game_thread.join();
+    EXPECT_NO_THROW(arena.setWorkerThreads(2));
+}
+
+TEST(TickPipelineTest, MovementOverlapsOnlyThePreviousCombat) {
+    using Clock = std::chrono::steady_clock;
+    struct Span {
+        Clock::time_point begin;
+        Clock::time_point end;
+    };
+    std::mutex mutex;
+    std::map<uint64_t, Span> moves;
+    std::map<uint64_t, Span> combats;
+    std::set<uint64_t> published;
+
+    TickPipeline::Stages stages;
+    stages.move = [&](uint64_t tick) {
+        auto begin = Clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        std::lock_guard<std::mutex> lock(mutex);
+        moves[tick] = {begin, Clock::now()};
+    };
+    stages.combat = [&](uint64_t tick) {
+        auto begin = Clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::lock_guard<std::mutex> lock(mutex);
+        combats[tick] = {begin, Clock::now()};
+    };
+    stages.publish = [&](uint64_t tick) {
+        std::lock_guard<std::mutex> lock(mutex);
+        published.insert(tick);
+    };
+
+    TickPipeline pipeline(stages, std::chrono::milliseconds(0));
+    pipeline.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    pipeline.stop();
+
+    PipelineStats stats = pipeline.getStats();
+    ASSERT_GT(stats.ticks, 5u);
+    // остановка доводит до публикации каждый тик, прошедший движение
+    EXPECT_EQ(moves.size(), stats.ticks);
+    EXPECT_EQ(combats.size(), stats.ticks);
+    EXPECT_EQ(published.size(), stats.ticks);
+    // бои дольше движения: следующий тик успевает сдвинуться во время боёв
+    EXPECT_GT(stats.overlapped, 0u);
+    EXPECT_EQ(stats.combat.count, stats.ticks);
+    EXPECT_GE(stats.combat.max, std::chrono::milliseconds(10));
+    EXPECT_GE(stats.end_to_end.max, stats.combat.max);
+
+    for (const auto& [tick, combat] : combats) {
+        EXPECT_GE(combat.begin, moves[tick].end) << tick;
+        // движение тика N+2 ждёт конца боёв тика N
+        auto later = moves.find(tick + 2);
+        if (later != moves.end()) {
+            EXPECT_GE(later->second.begin, combat.end) << tick;
+        }
+    }
+}
+
+TEST(AsyncThreadsTest, GamePublishesFramesOfCompletedTicks) {
+    Arena arena(100, 100);
+    arena.setSeed(21);
+    arena.generateRandomNpcs(50, false);
+    arena.startGame(1, 2);
+
+    PipelineStats stats = arena.getPipelineStats();
+    EXPECT_GT(stats.ticks, 0u);
+    EXPECT_EQ(stats.move.count, stats.ticks);
+    EXPECT_EQ(stats.publish.count, stats.ticks);
+    EXPECT_EQ(arena.getTickCount(), stats.ticks);
+    EXPECT_EQ(arena.snapshot()->tick, stats.ticks);
+    EXPECT_EQ(arena.getPendingBattles(), 0u);
+}
+
+TEST(AsyncThreadsTest, MetricsAreWrittenAtGameEnd) {
+    const std::string path = "test_metrics.json";
+    std::remove(path.c_str());
+
+    Arena arena(100, 100);
+    arena.generateRandomNpcs(50, false);
+    arena.setMetricsOutput(path, MetricsFormat::Json);
+    arena.startGame(1, 2);
+
+    std::ifstream file(path);
+    ASSERT_TRUE(file.is_open());
+    std::stringstream content;
+    content << file.rdbuf();
+    const uint64_t ticks = arena.getMetrics().findCounter("lab7_ticks_total")->get();
+    EXPECT_NE(content.str().find("\"lab7_ticks_total\": " + std::to_string(ticks)), std::string::npos);
+    EXPECT_NE(content.str().find("\"lab7_battle_wait_seconds\""), std::string::npos);
+#if LAB7_ENABLE_METRICS
+    EXPECT_GT(ticks, 0u);
+    EXPECT_EQ(arena.getMetrics().findHistogram("lab7_kills_per_tick")->count(), ticks / Arena::kMetricsTickPeriod);
+#endif
+    std::remove(path.c_str());
+}
+
+TEST(AsyncThreadsTest, RunningStatsMergeMatchesSinglePass) {
+    RunningStats whole, left, right;
+    for (int i = 0; i < 100; ++i) {
+        double value = (i * 37) % 11;
+        whole.add(value);
+        (i < 30 ? left : right).add(value);
+    }
+    left.merge(right);
+
+    EXPECT_EQ(left.count(), whole.count());
+    EXPECT_NEAR(left.mean(), whole.mean(), 1e-12);
+    EXPECT_NEAR(left.variance(), whole.variance(), 1e-9);
+    EXPECT_EQ(left.min(), whole.min());
+    EXPECT_EQ(left.max(), whole.max());
+}
+
+TEST(AsyncThreadsTest, CheckpointsDuringLiveGameCanBeResumed) {
+    const auto directory = std::filesystem::temp_directory_path() / "lab7_live_checkpoint_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    Arena arena(100, 100);
+    arena.setSeed(5);
+    arena.generateRandomNpcs(50, false);
+
+    Checkpointer checkpointer(arena, {directory.string(), std::chrono::milliseconds(100), 4});
+    checkpointer.start();
+    arena.startGame(1);
+    checkpointer.stop();
+
+    CheckpointStats stats = checkpointer.getStats();
+    EXPECT_GE(stats.full + stats.deltas, 3u);
+    EXPECT_EQ(stats.failures, 0u);
+
+    // последняя точка записана после остановки игры
+    Arena resumed(100, 100);
+    LoadReport report = resumed.restoreCheckpoint(directory.string());
+    EXPECT_TRUE(report.ok());
+    EXPECT_EQ(resumed.getNpcCount(), arena.getNpcCount());
+    EXPECT_EQ(resumed.getAliveCount(), arena.getAliveCount());
+    EXPECT_EQ(resumed.getTickCount(), arena.getTickCount());
+
+    std::filesystem::remove_all(directory);
 }
\ No newline at end of file